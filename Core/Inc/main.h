@@ -46,6 +46,10 @@ extern "C" {
 
 /* Exported macro ------------------------------------------------------------*/
 /* USER CODE BEGIN EM */
+// 控制环热路径的代码和状态放入CCM SRAM,零等待执行,不依赖ART缓存命中。
+// CCM SRAM不能被DMA访问,DMA缓冲区不能使用CCMRAM_DATA。
+#define CCMRAM_FUNC __attribute__((section(".ccmram_text")))
+#define CCMRAM_DATA __attribute__((section(".ccmram_data")))
 
 /* USER CODE END EM */
 
@@ -33,6 +33,9 @@
 #include "mean_filter.h"
 #include "incremental_pid.h"
 #include "comm.h"
+#include "fault_comp.h"
+#include "cycle_profiler.h"
+#include "cpu_monitor.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -59,17 +62,6 @@
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 /* USER CODE BEGIN PFP */
-void my_pid_init(void)
-{
-    incremental_pid_init(&pid_cap_voltage_h, 0.8f, 0.005f, 0, -CAP_CURRENT_MAX, CAP_CURRENT_MAX);
-    incremental_pid_init(&pid_cap_voltage_l, 0.8f, 0.005f, 0, -CAP_CURRENT_MAX, CAP_CURRENT_MAX);
-    incremental_pid_init(&pid_power, 0.0003f, 0.0004f, 0, -CAP_CURRENT_MAX, CAP_CURRENT_MAX);
-    incremental_pid_init(&pid_current, 0.001f, 0.00035f, 0, FACTOR_MIN, FACTOR_MAX);
-
-    pid_cap_voltage_h.setValue = CAP_VOLTAGE_MAX;
-    pid_cap_voltage_l.setValue = CAP_VOLTAGE_MIN;
-    pid_power.setValue         = DEFAULT_TARGET_POWER;
-}
 
 /* USER CODE END PFP */
 
@@ -118,6 +110,11 @@ int main(void)
     MX_TIM16_Init();
     /* USER CODE BEGIN 2 */
 
+#if (CYCLE_PROFILER_ENABLE)
+    // 执行周期统计,在所有中断开启前清零
+    cycle_profiler_init();
+#endif
+
     // 这部分要集合成一个函数
     // 初始化pid
     my_pid_init();
@@ -128,6 +125,9 @@ int main(void)
     BSP_ADC_Convert_Start();
     HAL_Delay(2);
 
+    // 比较器硬件保护,阈值依赖ADC启动时解析的校准数据
+    BSP_FAULT_Init();
+
     // can通讯初始化
     comm_init();
 
@@ -137,18 +137,25 @@ int main(void)
     // 启动定时器tim16
     HAL_TIM_Base_Start_IT(&htim16);
     HAL_Delay(2);
+#if (FSBB_LOOP_TRIGGER == FSBB_LOOP_TRIGGER_TIM6)
+    // ADC触发模式下控制环由ADC1序列转换完成中断驱动,不需要TIM6
     HAL_TIM_Base_Start_IT(&htim6);
+#endif
 
     //测试用-临时忽略保护
     HAL_Delay(2);
     fsbb_pwm_output_start();
     //
+
+    // 主循环只统计空闲时间
+    cpu_monitor_init();
         /* USER CODE END 2 */
 
         /* Infinite loop */
         /* USER CODE BEGIN WHILE */
         while (1)
     {
+        cpu_monitor_idle();
         // can_send();
         // HAL_Delay(114);
         // HAL_GPIO_TogglePin(USR_LED_GPIO_Port, USR_LED_Pin);
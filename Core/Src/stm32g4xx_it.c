@@ -22,6 +22,9 @@
 #include "stm32g4xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "analog_signal.h"
+#include "fault_comp.h"
+#include "cycle_profiler.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -215,11 +218,16 @@ void SysTick_Handler(void)
 void DMA1_Channel1_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel1_IRQn 0 */
-
+  CYCLE_PROFILER_BEGIN();
+#if (ADC_DMA_FAST_IRQ)
+  BSP_ADC1_DMA_IRQHandler();
+  CYCLE_PROFILER_END(CYCLE_PROBE_ADC1_DMA_IRQ);
+  return;
+#endif
   /* USER CODE END DMA1_Channel1_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_adc1);
   /* USER CODE BEGIN DMA1_Channel1_IRQn 1 */
-
+  CYCLE_PROFILER_END(CYCLE_PROBE_ADC1_DMA_IRQ);
   /* USER CODE END DMA1_Channel1_IRQn 1 */
 }
 
@@ -229,11 +237,16 @@ void DMA1_Channel1_IRQHandler(void)
 void DMA1_Channel2_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel2_IRQn 0 */
-
+  CYCLE_PROFILER_BEGIN();
+#if (ADC_DMA_FAST_IRQ)
+  BSP_ADC2_DMA_IRQHandler();
+  CYCLE_PROFILER_END(CYCLE_PROBE_ADC2_DMA_IRQ);
+  return;
+#endif
   /* USER CODE END DMA1_Channel2_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_adc2);
   /* USER CODE BEGIN DMA1_Channel2_IRQn 1 */
-
+  CYCLE_PROFILER_END(CYCLE_PROBE_ADC2_DMA_IRQ);
   /* USER CODE END DMA1_Channel2_IRQn 1 */
 }
 
@@ -243,11 +256,16 @@ void DMA1_Channel2_IRQHandler(void)
 void DMA1_Channel3_IRQHandler(void)
 {
   /* USER CODE BEGIN DMA1_Channel3_IRQn 0 */
-
+  CYCLE_PROFILER_BEGIN();
+#if (ADC_DMA_FAST_IRQ)
+  BSP_ADC3_DMA_IRQHandler();
+  CYCLE_PROFILER_END(CYCLE_PROBE_ADC3_DMA_IRQ);
+  return;
+#endif
   /* USER CODE END DMA1_Channel3_IRQn 0 */
   HAL_DMA_IRQHandler(&hdma_adc3);
   /* USER CODE BEGIN DMA1_Channel3_IRQn 1 */
-
+  CYCLE_PROFILER_END(CYCLE_PROBE_ADC3_DMA_IRQ);
   /* USER CODE END DMA1_Channel3_IRQn 1 */
 }
 
@@ -271,7 +289,9 @@ void DMA1_Channel6_IRQHandler(void)
 void ADC1_2_IRQHandler(void)
 {
   /* USER CODE BEGIN ADC1_2_IRQn 0 */
-
+  // ADC中断只使能了模拟看门狗
+  BSP_ADC_Watchdog_IRQHandler();
+  return;
   /* USER CODE END ADC1_2_IRQn 0 */
   HAL_ADC_IRQHandler(&hadc1);
   HAL_ADC_IRQHandler(&hadc2);
@@ -300,11 +320,11 @@ void FDCAN1_IT0_IRQHandler(void)
 void TIM1_UP_TIM16_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM1_UP_TIM16_IRQn 0 */
-
+  CYCLE_PROFILER_BEGIN();
   /* USER CODE END TIM1_UP_TIM16_IRQn 0 */
   HAL_TIM_IRQHandler(&htim16);
   /* USER CODE BEGIN TIM1_UP_TIM16_IRQn 1 */
-
+  CYCLE_PROFILER_END(CYCLE_PROBE_TIM16_IRQ);
   /* USER CODE END TIM1_UP_TIM16_IRQn 1 */
 }
 
@@ -314,7 +334,9 @@ void TIM1_UP_TIM16_IRQHandler(void)
 void ADC3_IRQHandler(void)
 {
   /* USER CODE BEGIN ADC3_IRQn 0 */
-
+  // ADC中断只使能了模拟看门狗
+  BSP_ADC_Watchdog_IRQHandler();
+  return;
   /* USER CODE END ADC3_IRQn 0 */
   HAL_ADC_IRQHandler(&hadc3);
   /* USER CODE BEGIN ADC3_IRQn 1 */
@@ -328,11 +350,11 @@ void ADC3_IRQHandler(void)
 void TIM6_DAC_IRQHandler(void)
 {
   /* USER CODE BEGIN TIM6_DAC_IRQn 0 */
-
+  CYCLE_PROFILER_BEGIN();
   /* USER CODE END TIM6_DAC_IRQn 0 */
   HAL_TIM_IRQHandler(&htim6);
   /* USER CODE BEGIN TIM6_DAC_IRQn 1 */
-
+  CYCLE_PROFILER_END(CYCLE_PROBE_TIM6_IRQ);
   /* USER CODE END TIM6_DAC_IRQn 1 */
 }
 
@@ -365,5 +387,13 @@ void LPUART1_IRQHandler(void)
 }
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles HRTIM fault global interrupt.
+  */
+void HRTIM1_FLT_IRQHandler(void)
+{
+  // 输出已由HRTIM硬件关闭,这里只做锁存和上报
+  BSP_FAULT_IRQHandler();
+}
 
 /* USER CODE END 1 */
@@ -2,7 +2,72 @@
 #ifndef __ANALOG_SIGNAL_H__
 #define __ANALOG_SIGNAL_H__
 
+#include <stdint.h>
+
+// 底盘电压/电流同步采样模式:
+// ADC3(主,PB13 ADC3_IN5)与ADC4(从,PB12 ADC4_IN3)工作在双重规则同步模式,
+// 同一个HRTIM_TRG1触发同时采样底盘电压和底盘电流,功率按每个采样对计算。
+// 底盘电压引脚只接到ADC3,因此同步采样只能使用ADC3/ADC4这一对,而不是ADC1/ADC2。
+#ifndef ADC_CHASSIS_DUAL_SIMULT
+#define ADC_CHASSIS_DUAL_SIMULT (0)
+#endif
+
+// DMA乒乓缓冲的块深度:每个半缓冲保存ADC_BLOCK_DEPTH次完整的序列转换,
+// 半传输/传输完成中断各处理一个数据块,DMA中断频率为ADC触发频率的1/ADC_BLOCK_DEPTH。
+// ADC触发控制环时,控制环也随数据块以相同的分频运行。
+#ifndef ADC_BLOCK_DEPTH
+#define ADC_BLOCK_DEPTH (1U)
+#endif
+
+// ADC快速序列:全部通道的采样时间由92.5缩短为6.5个ADC时钟,ADC2每次触发只转换一个电流/电压对。
+// ADC触发控制环并把FSBB_ADC_TRIGGER_DIV缩短到几个开关周期时使用,序列必须在下一次触发前结束,
+// 否则触发被ADC忽略,数据和控制环都会降速。缩短采样时间后需要在该配置下重新校准
+#ifndef ADC_FAST_SEQUENCE
+#define ADC_FAST_SEQUENCE (0)
+#endif
+
+// 最长的一次序列转换时间(ns),与adc.c和ADC_FAST_SEQUENCE的配置一致:
+// ADC时钟HCLK/4 = 42.5MHz,16倍过采样,每次转换为采样时间加12.5个ADC时钟
+#if (ADC_FAST_SEQUENCE)
+    #define ADC_CONVERSION_CYCLES (19U)  // 6.5 + 12.5
+    #define ADC_SEQUENCE_MAX_LEN  (2U)   // ADC1/ADC2/ADC3均为2次转换
+#else
+    #define ADC_CONVERSION_CYCLES (105U) // 92.5 + 12.5
+    #define ADC_SEQUENCE_MAX_LEN  (4U)   // ADC2: i_cap, v_cap, i_cap, v_cap
+#endif
+#define ADC_SEQUENCE_TIME_NS (ADC_SEQUENCE_MAX_LEN * 16ULL * ADC_CONVERSION_CYCLES * 1000000ULL / 42500ULL)
+
+// ADC DMA中断入口:
+// 1 - 寄存器级入口,直接读写DMA中断标志并调用对应ADC的数据块处理,不经过HAL_DMA_IRQHandler和回调分发
+// 0 - HAL_DMA_IRQHandler -> HAL_ADC_ConvHalfCpltCallback/HAL_ADC_ConvCpltCallback
+#ifndef ADC_DMA_FAST_IRQ
+#define ADC_DMA_FAST_IRQ (1)
+#endif
+
+// 模拟看门狗越限的通道
+#define ADC_AWD_TRIP_V_CAP   (0x01U) // 电容电压,ADC2 AWD1
+#define ADC_AWD_TRIP_I_CAP   (0x02U) // 电容电流,ADC2 AWD2
+#define ADC_AWD_TRIP_V_MOTOR (0x04U) // 底盘电压,ADC3 AWD1
+
+// 模拟信号通道,用于实际值与原始值的换算
+typedef enum
+{
+    ADC_SIGNAL_V_MOTOR = 0, // 底盘电压
+    ADC_SIGNAL_I_CHASSIS,   // 底盘电流
+    ADC_SIGNAL_V_CAP,       // 电容电压
+    ADC_SIGNAL_I_CAP,       // 电容电流
+} adc_signal_t;
+
 extern void BSP_ADC_Convert_Start(void);
+extern void BSP_ADC1_DMA_IRQHandler(void);
+extern void BSP_ADC2_DMA_IRQHandler(void);
+extern void BSP_ADC3_DMA_IRQHandler(void);
+extern void BSP_ADC_Watchdog_IRQHandler(void);
+extern void BSP_ADC_WatchdogCallback(uint32_t source);
+extern uint32_t get_adc_watchdog_trip_source();
+extern uint32_t get_adc_watchdog_derated();
+extern void BSP_ADC_SequenceCpltCallback(void);
+extern uint8_t BSP_ADC_SequencePending(void);
 
 extern float get_voltage_chassis();
 extern float get_voltage_motor();
@@ -10,5 +75,18 @@ extern float get_voltage_cap();
 extern float get_current_chassis();
 extern float get_current_motor();
 extern float get_current_cap();
+// Q16定点数(16位小数)形式的测量值,单位V/A
+extern int32_t get_voltage_motor_q16();
+extern int32_t get_voltage_cap_q16();
+extern int32_t get_current_chassis_q16();
+extern int32_t get_current_cap_q16();
+extern float get_power_chassis();
+extern float get_power_cap();
+extern float get_energy_chassis();
+extern float get_energy_cap();
+extern void reset_energy();
+extern uint8_t get_adc_calibration_is_default();
+extern uint16_t get_adc_raw_from_value(adc_signal_t signal, float value);
+extern float get_adc_trip_limit(adc_signal_t signal, float value);
 
 #endif // !__ANALOG_SIGNAL_H__
@@ -5,11 +5,25 @@
 
 #include "main.h"
 
-#define RMCS_ID     (0x1FE)
-#define LEGGED_ID   (0x427)
-#define SUPERCAP_ID (0x300)
+#define RMCS_ID             (0x1FE)
+#define LEGGED_ID           (0x427)
+#define SUPERCAP_ID         (0x300)
+#define SUPERCAP_PROFILE_ID (0x301) // 执行周期统计帧,CYCLE_PROFILER_ENABLE时发送
+#define SUPERCAP_LOAD_ID    (0x302) // CPU占用率与控制环超时帧
+#define SUPERCAP_BURST_ID   (0x303) // 轻载突发模式统计帧,突发模式前后实测的净输入功率
+#define SUPERCAP_ENERGY_ID  (0x304) // 开启输出以来底盘端/电容端的累计能量帧
 // #define SUPERCAP_ID              (0x209)//test
 #define CAN_DISCONNECT_MAX_COUNT (500)
+#define CAN_LOAD_SEND_DIV        (50) // CPU占用率帧的发送分频,与CPU_MONITOR_WINDOW_MS相同的100ms
+#define CAN_BURST_SEND_DIV       (50) // 突发模式统计帧的发送分频,100ms
+#define CAN_ENERGY_SEND_DIV      (50) // 累计能量帧的发送分频,100ms
+
+// 状态帧data[7]的标志位
+#define SUPERCAP_FLAG_CALI_DEFAULT (0x01U) // 没有与UID匹配的校准数据,正在使用默认校准
+#define SUPERCAP_FLAG_FAULT        (0x02U) // 硬件保护触发,输出已关闭,上位机关闭输出后清除
+#define SUPERCAP_FLAG_OVERRUN      (0x04U) // 上一帧以来控制环发生过超时
+#define SUPERCAP_FLAG_BURST        (0x08U) // 处于轻载突发模式
+#define SUPERCAP_FLAG_TRIP_DERATED (0x10U) // 有保护阈值超出传感器测量范围,已收紧到量程内,实际触发值低于设定值
 
 typedef enum {
     DCDC_OUTPUT_OUTPUT_DISABLED,        // 关闭输出
@@ -30,7 +44,7 @@ typedef struct
     uint16_t supercap_voltage; // 超级电容电压
     uint16_t chassis_voltage;  // 底盘电压
     uint8_t enabled;           // 栅极驱动开启状态
-    uint8_t unused;            // 未使用
+    uint8_t flags;             // 状态标志,SUPERCAP_FLAG_xxx
 } TxData;
 
 extern DcdcOutputState get_dcdc_output_state(void);
@@ -38,6 +52,10 @@ extern RxData can_rx_data;
 extern TxData can_tx_data;
 extern void comm_init(void);
 extern void can_send(void);
+extern void can_send_profile(void);
+extern void can_send_load(void);
+extern void can_send_burst(void);
+extern void can_send_energy(void);
 extern DcdcOutputState UpdateDcdcOutputState(uint8_t IsEnabled);
 extern void can_recevie_cnt_add(void);
 extern void can_recevie_cnt_reset(void);
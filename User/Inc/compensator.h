@@ -0,0 +1,56 @@
+#pragma once
+#ifndef __COMPENSATOR_H__
+#define __COMPENSATOR_H__
+
+#include <stdint.h>
+
+// 2p2z/3p3z数字补偿器(直接I型IIR):
+// u[n] = b0·e[n] + b1·e[n-1] + ... + bN·e[n-N] + a1·u[n-1] + ... + aN·u[n-N]
+// 历史输出保存限幅后的值,输出饱和时积分不会继续累积(抗积分饱和)。
+//
+// 两种后端:
+// COMPENSATOR_BACKEND_FLOAT - CPU单精度浮点计算
+// COMPENSATOR_BACKEND_FMAC  - FMAC外设的IIR功能计算,CPU只写入误差、读出输出。
+//                             系数和数据为q1.15定点数,误差按in_range、输出按限幅范围归一化,
+//                             输出限幅由FMAC的CLIPEN在写回Y缓冲区前完成,同样具有抗积分饱和作用。
+//                             归一化时对输出做了平移,要求补偿器含积分环节(反馈系数之和为1)。
+//                             FMAC只有一个,同一时刻只能有一个补偿器使用这个后端。
+#define COMPENSATOR_ORDER_MAX (3U)
+
+typedef enum
+{
+    COMPENSATOR_BACKEND_FLOAT = 0,
+    COMPENSATOR_BACKEND_FMAC,
+} compensator_backend_t;
+
+typedef struct
+{
+    uint8_t order;                      // 阶数,2或3
+    compensator_backend_t backend;      // 计算后端
+    float b[COMPENSATOR_ORDER_MAX + 1]; // 前馈系数b0~bN
+    float a[COMPENSATOR_ORDER_MAX];     // 反馈系数a1~aN
+    float output_min, output_max;       // 输出限幅
+
+    // 浮点后端的状态
+    float e[COMPENSATOR_ORDER_MAX]; // e[n-1] ~ e[n-N]
+    float u[COMPENSATOR_ORDER_MAX]; // u[n-1] ~ u[n-N],限幅后的值
+    float output;                   // 最近一次输出
+
+    // FMAC后端的定点参数
+    float in_scale;                           // 误差 -> q1.15
+    float out_scale, out_offset;              // q1.15 -> 输出
+    int16_t b_q15[COMPENSATOR_ORDER_MAX + 1]; // 缩小2^gain倍后的前馈系数
+    int16_t a_q15[COMPENSATOR_ORDER_MAX];     // 缩小2^gain倍后的反馈系数
+    uint8_t gain;                             // FMAC的R,累加结果左移的位数
+} compensator_t;
+
+extern void compensator_init_pid(compensator_t *comp, float kp, float ki, float kd, float min_output, float max_output);
+extern void compensator_init_type2(compensator_t *comp, float k, float f_zero, float f_pole, float f_sample,
+                                   float min_output, float max_output);
+extern void compensator_init_type3(compensator_t *comp, float k, float f_zero1, float f_zero2, float f_pole1, float f_pole2,
+                                   float f_sample, float min_output, float max_output);
+extern void compensator_fmac_attach(compensator_t *comp, float in_range);
+extern void compensator_reset(compensator_t *comp, float output);
+extern float compensator_compute(compensator_t *comp, float error);
+
+#endif // !__COMPENSATOR_H__
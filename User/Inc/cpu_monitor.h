@@ -0,0 +1,23 @@
+#pragma once
+#ifndef __CPU_MONITOR_H__
+#define __CPU_MONITOR_H__
+
+#include <stdint.h>
+#include "main.h"
+
+// CPU占用率统计窗口,ms
+#ifndef CPU_MONITOR_WINDOW_MS
+#define CPU_MONITOR_WINDOW_MS (100U)
+#endif
+
+extern void cpu_monitor_init(void);
+extern void cpu_monitor_idle(void);
+extern void cpu_monitor_overrun(void);
+
+// CPU占用率,千分比
+extern uint16_t get_cpu_load(void);
+extern uint16_t get_cpu_load_max(void);
+// 控制环超时次数
+extern uint32_t get_loop_overrun_count(void);
+
+#endif // !__CPU_MONITOR_H__
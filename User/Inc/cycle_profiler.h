@@ -0,0 +1,62 @@
+#pragma once
+#ifndef __CYCLE_PROFILER_H__
+#define __CYCLE_PROFILER_H__
+
+#include <stdint.h>
+#include "main.h"
+
+// 中断和热点函数的执行周期统计,基于DWT周期计数器。
+// 统计的是从埋点开始到结束的全部周期,包含期间被更高优先级中断抢占的时间。
+// 关闭时埋点宏展开为空语句,不占用代码和RAM。
+#ifndef CYCLE_PROFILER_ENABLE
+#define CYCLE_PROFILER_ENABLE (0)
+#endif
+
+// 直方图为CYCLE_PROFILER_BIN_NUM个等宽区间,宽度2^CYCLE_PROFILER_BIN_SHIFT个周期,最后一个区间包含所有更长的执行时间。
+// 默认512周期 x 16,覆盖0~8192周期,20kHz控制周期约为8500个CPU周期。
+#ifndef CYCLE_PROFILER_BIN_SHIFT
+#define CYCLE_PROFILER_BIN_SHIFT (9U)
+#endif
+#define CYCLE_PROFILER_BIN_NUM (16U)
+
+// 埋点
+typedef enum
+{
+    CYCLE_PROBE_TIM6_IRQ = 0, // TIM6中断,FSBB_LOOP_TRIGGER_TIM6时包含控制环
+    CYCLE_PROBE_TIM16_IRQ,    // TIM16中断,CAN发送、断联计数、掉电检测
+    CYCLE_PROBE_ADC1_DMA_IRQ, // ADC1 DMA中断,FSBB_LOOP_TRIGGER_ADC时包含控制环
+    CYCLE_PROBE_ADC2_DMA_IRQ, // ADC2 DMA中断
+    CYCLE_PROBE_ADC3_DMA_IRQ, // ADC3 DMA中断
+    CYCLE_PROBE_CONTROL_LOOP, // fsbb_control_loop
+    CYCLE_PROBE_CAN_RX,       // HAL_FDCAN_RxFifo0Callback
+    CYCLE_PROBE_CAN_SEND,     // can_send
+    CYCLE_PROBE_NUM,
+} cycle_probe_t;
+
+// 一个埋点的统计
+typedef struct
+{
+    uint32_t count;                        // 采样次数
+    uint32_t min;                          // 最小周期数
+    uint32_t max;                          // 最大周期数
+    uint64_t sum;                          // 周期数之和,用于求均值
+    uint32_t hist[CYCLE_PROFILER_BIN_NUM]; // 直方图
+} cycle_stats_t;
+
+#if (CYCLE_PROFILER_ENABLE)
+// 放在被测代码开头,同一作用域内只能使用一次
+#define CYCLE_PROFILER_BEGIN()    uint32_t cycle_profiler_start = DWT->CYCCNT
+#define CYCLE_PROFILER_END(probe) cycle_profiler_record((probe), DWT->CYCCNT - cycle_profiler_start)
+
+extern void cycle_profiler_init(void);
+extern void cycle_profiler_reset(void);
+extern void cycle_profiler_record(cycle_probe_t probe, uint32_t cycles);
+extern const cycle_stats_t *cycle_profiler_get(cycle_probe_t probe);
+extern uint32_t cycle_profiler_get_mean(cycle_probe_t probe);
+extern void cycle_profiler_frame(uint8_t data[8]);
+#else
+#define CYCLE_PROFILER_BEGIN()    ((void)0)
+#define CYCLE_PROFILER_END(probe) ((void)0)
+#endif
+
+#endif // !__CYCLE_PROFILER_H__
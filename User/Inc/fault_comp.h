@@ -0,0 +1,37 @@
+#pragma once
+#ifndef __FAULT_COMP_H__
+#define __FAULT_COMP_H__
+
+#include <stdint.h>
+#include "main.h"
+
+// 比较器硬件保护:内部COMPx同相输入接采样信号,反相输入接DAC3/DAC4给出的阈值,
+// 比较器输出作为HRTIM内部故障输入,越限时TA1/TA2/TD1/TD2由HRTIM直接置为无效电平,不需要CPU参与。
+// 故障中断只用于锁存和上报。
+#ifndef FAULT_COMP_ENABLE
+#define FAULT_COMP_ENABLE (1)
+#endif
+
+// 电感(电容侧)过流通道。
+// 本板电容电流采样PB2只连接到COMP4的反相输入,无法与内部DAC阈值比较;
+// 需要把电流采样接到COMP1同相输入PB1后才能开启。
+#ifndef FAULT_COMP_OCP_ENABLE
+#define FAULT_COMP_OCP_ENABLE (0)
+#endif
+
+// 比较器越限的通道
+#define FAULT_COMP_TRIP_V_MOTOR (0x01U) // 底盘过压,COMP5(PB13) vs DAC4_CH1 -> FLT6
+#define FAULT_COMP_TRIP_I_CAP   (0x02U) // 电容侧正向过流,COMP1(PB1) vs DAC3_CH1 -> FLT4
+
+extern void BSP_COMP_DAC_Init(DAC_TypeDef *dac, uint32_t channel, uint16_t value);
+extern void BSP_COMP_DAC_Set(DAC_TypeDef *dac, uint32_t channel, uint16_t value);
+extern void BSP_FAULT_Init(void);
+extern void BSP_FAULT_Arm(void);
+extern HAL_StatusTypeDef BSP_FAULT_Clear(void);
+extern void BSP_FAULT_IRQHandler(void);
+extern void BSP_FAULT_Callback(uint32_t source);
+extern uint32_t get_fault_comp_active();
+extern uint32_t get_fault_comp_trip_source();
+extern uint32_t get_fault_comp_derated();
+
+#endif // !__FAULT_COMP_H__
@@ -13,21 +13,206 @@ extern "C" {
 #define CAP_VOLTAGE_MIN      (8.0f)  // 电容组最小电压
 #define CAP_CURRENT_MAX      (15.0f) // 电容组最大电流
 
+// ADC模拟看门狗硬件保护阈值,超出后在中断中立即关闭HRTIM输出并锁存故障
+#define CAP_VOLTAGE_TRIP   (CAP_VOLTAGE_MAX + 2.0f) // 电容组过压
+#define CAP_CURRENT_TRIP   (CAP_CURRENT_MAX + 5.0f) // 电容组过流,充放电两个方向
+#define MOTOR_VOLTAGE_TRIP (30.0f)                  // 底盘过压
+
 #define FACTOR_MAX           (1.23f) // 27V电容组 / 22V 底盘
 #define FACTOR_MIN           (0.15f) // 4V电容组 / 26V 底盘
 
+// 控制环触发源
+#define FSBB_LOOP_TRIGGER_TIM6 (0U) // 由自由运行的TIM6中断触发,与HRTIM不同步
+#define FSBB_LOOP_TRIGGER_ADC  (1U) // 由HRTIM_TRG1触发的底盘侧ADC序列转换完成触发,与开关周期锁相
+
+#ifndef FSBB_LOOP_TRIGGER
+#define FSBB_LOOP_TRIGGER FSBB_LOOP_TRIGGER_TIM6
+#endif
+
+// ADC触发HRTIM_TRG1/TRG3的后分频,即相邻两次ADC序列转换之间的开关周期数,覆盖hrtim.c中的配置。
+// ADC触发模式下也是电流内环的运行周期,最长的ADC序列必须在这段时间内完成,否则编译报错:
+// 默认采样配置下ADC2的序列约158us,需要32个开关周期;开启ADC_FAST_SEQUENCE后约14us,可以缩短到3~4个开关周期。
+// 定时器触发模式下电流内环仍按FSBB_LOOP_FREQ运行,此分频只影响采样,被ADC忽略的触发只降低数据速率。
+#ifndef FSBB_ADC_TRIGGER_DIV
+#define FSBB_ADC_TRIGGER_DIV (10U)
+#endif
+
+// 多速率调度:每次控制环触发都运行电流内环,功率环和电容电压环按分频降速运行。
+// 电压环在第0拍,功率环在第1拍,两者错开,功率环使用最近一次的电压环输出作为限幅。
+// 外环的积分增益按分频比放大,保持与全速运行时相同的连续域增益。
+#ifndef FSBB_POWER_LOOP_DIV
+#define FSBB_POWER_LOOP_DIV (4U)
+#endif
+
+#ifndef FSBB_VOLTAGE_LOOP_DIV
+#define FSBB_VOLTAGE_LOOP_DIV (8U)
+#endif
+
+// 内环控制方式
+// 电压模式:pid_current输出广义占空比,由fsbb_pwm_set_factor换算为比较值
+// 电流模式:外环输出的电流给定经DAC3_CH1作为COMP1(PB1)的阈值,比较器经HRTIM EEV4逐周期
+//         截断开关管导通,内环长度为一个开关周期。给定为正时为峰值模式,为负时反转比较器极性作为谷值模式。
+//         DAC3_CH1以锯齿波模式叠加斜坡补偿(TIM7给出步进),EEV4在导通开始后的死区和开通尖峰期间被消隐。
+//         需要电容侧电流采样接到PB1,与FAULT_COMP_OCP_ENABLE共用COMP1/DAC3_CH1,不能同时开启。
+#define FSBB_CONTROL_MODE_VOLTAGE (0U)
+#define FSBB_CONTROL_MODE_CURRENT (1U)
+
+#ifndef FSBB_CONTROL_MODE
+#define FSBB_CONTROL_MODE FSBB_CONTROL_MODE_VOLTAGE
+#endif
+
+// 电压模式下电容电流内环的控制律
+// PID:   增量式PID,即fsbb_pid[FSBB_PID_CURRENT]
+// TYPE2: Type-II补偿器(2p2z),积分 + 一个零点 + 一个高频极点,默认参数在穿越频率以下与PID相同
+// TYPE3: Type-III补偿器(3p3z),再增加一对零极点提供相位超前
+#define FSBB_CURRENT_LAW_PID   (0U)
+#define FSBB_CURRENT_LAW_TYPE2 (1U)
+#define FSBB_CURRENT_LAW_TYPE3 (2U)
+
+#ifndef FSBB_CURRENT_LAW
+#define FSBB_CURRENT_LAW FSBB_CURRENT_LAW_PID
+#endif
+
+// 1 - 电流内环的补偿器在FMAC上计算,CPU只写入误差、读出输出;PID控制律按等效的2p2z系数计算
+// 0 - CPU浮点计算
+#ifndef FSBB_CURRENT_COMP_FMAC
+#define FSBB_CURRENT_COMP_FMAC (0)
+#endif
+
+// 电压模式下电流内环的占空比前馈:每次控制环由测得的电容/底盘电压计算理想电压比,
+// 并按回路电阻压降和死区补偿,内环控制律只输出前馈之外的残差,不需要积分出整个电压比
+#ifndef FSBB_DUTY_FEEDFORWARD
+#define FSBB_DUTY_FEEDFORWARD (1)
+#endif
+
+// 电压模式的三区调制:电压比在1 ± FSBB_BUCK_BOOST_BAND内为升降压过渡区,两个桥臂同时调制,
+// 电容侧广义占空比随电压比从1线性降到1/(1 + FSBB_BUCK_BOOST_BAND),底盘侧按电压比配合,
+// 过渡区两端与buck/boost区的占空比和小信号增益连续。进入过渡区有迟滞,避免在区边界来回切换。
+// 0 - 以电压比1为界在buck/boost两区之间直接切换
+#ifndef FSBB_BUCK_BOOST_MODULATION
+#define FSBB_BUCK_BOOST_MODULATION (1)
+#endif
+
+#ifndef FSBB_BUCK_BOOST_BAND
+#define FSBB_BUCK_BOOST_BAND (0.05f)
+#endif
+
+// 1 - 比较值由HRTIM突发DMA更新:控制环只把Timer A/D的CMP1/CMP3写入内存中的比较值块,
+//     主定时器重复事件(与控制环同频)触发DMA1_CH4经BDMADR写入两个定时器,写完后Timer A/D立即更新。
+//     比较值生效的时刻由硬件决定,不受FDCAN/LPUART等中断嵌套的影响。仅支持ADC触发的控制环,
+//     控制环需要在下一次重复事件前完成,否则新旧比较值可能混合生效。
+// 0 - CPU在禁止更新期间直接写比较值寄存器
+#ifndef FSBB_PWM_BURST_DMA
+#define FSBB_PWM_BURST_DMA (0)
+#endif
+
+// 开关频率范围。开关周期是运行时参数,由fsbb_pwm_set_frequency修改,比较值、ADC触发位置和死区前馈都按当前周期换算。
+// 下限受Timer A/D周期寄存器限制(HRTIM时钟×32时不低于84kHz)。
+// ADC触发的控制环运行频率与开关频率成正比,环路的离散增益不变,连续域带宽随开关频率变化。
+#ifndef FSBB_SWITCHING_FREQ_MIN
+#define FSBB_SWITCHING_FREQ_MIN (100000U) // Hz
+#endif
+
+#ifndef FSBB_SWITCHING_FREQ_MAX
+#define FSBB_SWITCHING_FREQ_MAX (200000U) // Hz,hrtim.c中配置的标称频率
+#endif
+
+// 1 - 按滤波后的电容电流自动选择开关频率:电流不大于FSBB_FREQ_CURRENT_LIGHT时为下限,降低开关损耗;
+//     不小于FSBB_FREQ_CURRENT_HEAVY时为上限,限制电感纹波;之间分档线性过渡,换档有迟滞。
+//     只用于TIM6触发的控制环,ADC触发时轻载降频会同时降低控制环频率,负载突变的响应变慢。
+//     ADC触发分频FSBB_ADC_TRIGGER_DIV、均值滤波和功率计窗口都按采样点计数,不随fsbb_period缩放,
+//     降频后窗口时间变长,仿真中启动稳定时间由117ms增加到233ms,默认关闭
+// 0 - 固定为FSBB_SWITCHING_FREQ_MAX,可以由fsbb_pwm_set_frequency手动修改
+#ifndef FSBB_ADAPTIVE_FREQUENCY
+#define FSBB_ADAPTIVE_FREQUENCY (0)
+#endif
+
+#ifndef FSBB_FREQ_CURRENT_LIGHT
+#define FSBB_FREQ_CURRENT_LIGHT (2.0f) // A
+#endif
+
+#ifndef FSBB_FREQ_CURRENT_HEAVY
+#define FSBB_FREQ_CURRENT_HEAVY (8.0f) // A
+#endif
+
+// 电压模式的轻载突发模式:变换器处理的功率(电容电流给定与实测电流中较大者 × 电容电压)持续低于
+// FSBB_BURST_POWER_ENTER后,由HRTIM突发模式控制器关闭开关,每个突发周期只保留一小段开关刷新自举电容。
+// 功率超过FSBB_BURST_POWER_EXIT或电容电压偏离进入时的值超过FSBB_BURST_RIPPLE时立即退出,
+// 内环从电压比重新开始。电容电压高于底盘电压时关断期间体二极管会放电,此时不进入突发模式。
+// 只在主机仿真中验证过,没有在板上验证前默认关闭。
+#ifndef FSBB_BURST_MODE
+#define FSBB_BURST_MODE (0)
+#endif
+
+// 轻载突发模式只用于电压模式
+#define FSBB_BURST ((FSBB_BURST_MODE) && (FSBB_CONTROL_MODE == FSBB_CONTROL_MODE_VOLTAGE))
+
+#ifndef FSBB_BURST_POWER_ENTER
+#define FSBB_BURST_POWER_ENTER (2.0f) // W
+#endif
+
+#ifndef FSBB_BURST_POWER_EXIT
+#define FSBB_BURST_POWER_EXIT (4.0f) // W
+#endif
+
+#ifndef FSBB_BURST_RIPPLE
+#define FSBB_BURST_RIPPLE (0.1f) // V
+#endif
+
+// 电流内环PID增益调度(PID控制律、CPU计算时有效):
+// 按上一次的电压比和工作区(底盘侧开关/电容侧开关)查表,表内线性插值,每次控制环更新增益。
+// 每个工作区FSBB_GAIN_TABLE_SIZE个等间距的点,底盘侧开关覆盖FACTOR_MIN~1,电容侧开关覆盖1~FACTOR_MAX。
+// 升降压过渡区不单独建表,在buck表与boost表的过渡区两端之间插值。
+// 表格可以通过fsbb_current_gain_set在运行中修改。
+#ifndef FSBB_CURRENT_GAIN_SCHEDULE
+#define FSBB_CURRENT_GAIN_SCHEDULE (1)
+#endif
+
+#define FSBB_GAIN_TABLE_SIZE (5U)
+
+typedef enum
+{
+    FSBB_REGION_BUCK = 0, // 电压比不大于1,底盘侧桥臂开关
+    FSBB_REGION_BOOST,    // 电压比大于1,电容侧桥臂开关
+    FSBB_REGION_NUM,
+} fsbb_region_t;
+
+typedef struct
+{
+    float kp, ki; // 增量式PID的比例、积分系数
+} fsbb_gain_t;
+
 extern void fsbb_pwm_init(void);
 extern void fsbb_pwm_output_start(void);
 extern void fsbb_pwm_output_restart(void);
 extern void fsbb_pwm_output_stop(void);
-extern void fsbb_pwm_set_cap(float general_duty);
-extern void fsbb_pwm_set_motor(float general_duty);
+extern void fsbb_pwm_set_duty(float motor_duty, float cap_duty);
+extern void fsbb_pwm_set_frequency(float frequency);
+extern float fsbb_pwm_get_frequency(void);
 extern void fsbb_pwm_set_factor(float scaling_factor);
+extern void fsbb_pwm_set_current(float current_ref, float scaling_factor);
+extern void fsbb_control_loop(void);
+extern void fsbb_pwm_fault_trip(void);
+extern void fsbb_pwm_fault_clear(void);
+extern uint8_t fsbb_pwm_fault_get(void);
+extern void fsbb_current_gain_set(fsbb_region_t region, uint32_t index, fsbb_gain_t gain);
+extern fsbb_gain_t fsbb_current_gain_get(fsbb_region_t region, uint32_t index);
+extern uint8_t fsbb_burst_get_state(void);
+extern void fsbb_burst_get_power(float *base, float *saved);
+extern uint16_t fsbb_burst_get_residency(void);
+extern uint32_t fsbb_burst_get_entries(void);
+
+// 级联控制的PID计算核,按fsbb_pid_index_t连续存放
+typedef enum
+{
+    FSBB_PID_CAP_VOLTAGE_H = 0, // 电容组电压上限环,输出电容电流给定的上限
+    FSBB_PID_CAP_VOLTAGE_L,     // 电容组电压下限环,输出电容电流给定的下限
+    FSBB_PID_POWER,             // 底盘功率环,输出电容电流给定
+    FSBB_PID_CURRENT,           // 电容电流内环,输出电压比
+    FSBB_PID_NUM,
+} fsbb_pid_index_t;
 
-extern incremental_pid_t pid_cap_voltage_h;
-extern incremental_pid_t pid_cap_voltage_l;
-extern incremental_pid_t pid_power;
-extern incremental_pid_t pid_current;
+extern pid_kernel_t fsbb_pid[FSBB_PID_NUM];
 
 #ifdef __cplusplus
 }
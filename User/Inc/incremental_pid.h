@@ -7,24 +7,61 @@ extern "C"
 {
     #endif
 
+    #include <stdint.h>
+
+    // 预计算系数的增量式PID计算核:
+    // u[k] = u[k-1] + a0·e[k] + a1·e[k-1] + a2·e[k-2]
+    // a0 = Kp + Ki + Kd, a1 = -(Kp + 2·Kd), a2 = Kd
+    // 每次计算3次乘加,只读写误差历史和输出。多个计算核连续存放时可以用pid_kernel_compute_batch一次计算。
+    typedef struct
+    {
+        float a0, a1, a2;             // 预计算的系数
+        float e1, e2;                 // E[k-1], E[k-2]
+        float output;                 // 当前输出值,可以在外部修改(例如限幅跟踪),下次计算时生效
+        float output_min, output_max; // 输出限幅
+    } pid_kernel_t;
+
     typedef struct incremental_pid_t_
     {
-        float actualValue;    // 实际值 每次反馈回来的值
-        float Kd, Ki, Kp;     // 比例、积分、微分常数
-        float P, I, D;        // 比例项 积分项 微分项
-        float error;          // 本次误差值
-        float errorPre;       // E[k-1] 上一次误差
-        float errorPrePre;    // E[k-2] 上上次误差
-        float setValue;       // 设定值 你期望系统达到的值
-        float output;         // 当前输出值
-        float outputMaxLimit; // 输出的最大限制
-        float outputMinLimit; // 输出的最小限制
+        float actualValue; // 实际值 每次反馈回来的值
+        float Kd, Ki, Kp;  // 比例、积分、微分常数,计算使用kernel中的系数
+        float error;       // 本次误差值
+        float setValue;    // 设定值 你期望系统达到的值
+        float output;      // 当前输出值
+        pid_kernel_t kernel;
     } incremental_pid_t;
 
+    void pid_kernel_init(pid_kernel_t* kernel, float kp, float ki, float kd, float min_output, float max_output);
+    void pid_kernel_reset(pid_kernel_t* kernel);
+    void pid_kernel_compute_batch(pid_kernel_t* kernel, const float* error, float* output, uint32_t n);
+
     void incremental_pid_init(incremental_pid_t* pid, float kp, float ki, float kd, float min_output, float max_output);
     float incremental_pid_compute(incremental_pid_t* pid, float newActualValue);
     void  incremental_pid_reset(incremental_pid_t* pid);
 
+    // 更新计算核的增益,误差历史和输出不变。增量式计算下一次增量直接使用新的增益,切换时输出不跳变
+    static inline void pid_kernel_set_gains(pid_kernel_t* kernel, float kp, float ki, float kd)
+    {
+        kernel->a0 = kp + ki + kd;
+        kernel->a1 = -(kp + 2.0f * kd);
+        kernel->a2 = kd;
+    }
+
+    // 计算一个计算核,error为本次误差(设定值 - 实际值)
+    static inline float pid_kernel_compute(pid_kernel_t* kernel, float error)
+    {
+        float output = kernel->output + kernel->a0 * error + kernel->a1 * kernel->e1 + kernel->a2 * kernel->e2;
+
+        output = (output > kernel->output_max)   ? kernel->output_max
+                 : (output < kernel->output_min) ? kernel->output_min
+                                                 : output;
+
+        kernel->e2     = kernel->e1;
+        kernel->e1     = error;
+        kernel->output = output;
+        return output;
+    }
+
     #ifdef __cplusplus
 }
     #endif
@@ -8,21 +8,41 @@
 #define MAX_WINDOW_SIZE 64
 
 // 均值滤波器结构体
+// 块模式下窗口中的每个元素是一个数据块内若干样本的和
 typedef struct
 {
-    uint16_t window[MAX_WINDOW_SIZE]; // 存储样本的窗口
+    uint32_t window[MAX_WINDOW_SIZE]; // 存储样本(块模式下为块内样本和)的窗口
     uint16_t window_size;             // 窗口大小
     uint16_t head;                    // 指向最新样本的位置
+    uint16_t samples_per_entry;       // 窗口中每个元素包含的样本数,逐样本更新时为1
     uint32_t sum;                     // 窗口内样本的总和
 } mean_filter_t;
 
 // 初始化均值滤波器
 void mean_filter_init(mean_filter_t* filter, uint16_t size);
 
+// 初始化块模式均值滤波器
+void mean_filter_init_block(mean_filter_t* filter, uint16_t size, uint16_t samples_per_entry);
+
 // 更新均值滤波器状态
 void mean_filter_update(mean_filter_t* filter, uint16_t new_sample);
 
+// 以一个数据块内样本的和更新均值滤波器状态
+void mean_filter_update_block(mean_filter_t* filter, uint32_t block_sum);
+
 // 计算当前平均值
 uint16_t mean_filter_calculate_average(const mean_filter_t* filter);
 
+// 窗口内样本的总和
+static inline uint32_t mean_filter_get_sum(const mean_filter_t* filter)
+{
+    return filter->sum;
+}
+
+// 窗口内样本的总数,块模式下为窗口元素数乘以每个元素包含的样本数
+static inline uint32_t mean_filter_get_count(const mean_filter_t* filter)
+{
+    return (uint32_t)filter->window_size * filter->samples_per_entry;
+}
+
 #endif // !__MEAN_FILTER_H__
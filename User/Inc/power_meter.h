@@ -0,0 +1,48 @@
+#pragma once
+#ifndef __POWER_METER_H__
+#define __POWER_METER_H__
+
+#include <stdint.h>
+
+// 定义功率计的最大窗口大小
+#define POWER_METER_MAX_WINDOW_SIZE 64
+
+// 功率计结构体
+// 以同一时刻采样的电压/电流原始值对为单位,统计窗口内的平均功率和复位以来的累计能量
+typedef struct
+{
+    uint16_t v[POWER_METER_MAX_WINDOW_SIZE]; // 电压原始值窗口
+    uint16_t i[POWER_METER_MAX_WINDOW_SIZE]; // 电流原始值窗口
+    uint16_t window_size;                    // 窗口大小
+    uint16_t head;                           // 指向最旧采样对的位置
+    uint32_t sum_v;                          // 窗口内Σv
+    uint32_t sum_i;                          // 窗口内Σi
+    uint64_t sum_vi;                         // 窗口内Σv·i
+
+    float v_k, v_b; // 电压线性映射参数
+    float i_k, i_b; // 电流线性映射参数
+
+    int64_t energy_acc;   // 复位以来的累计能量,单位mW·CPU周期
+    uint32_t last_cycle;  // 上一个采样对的DWT周期计数
+    uint8_t has_last;     // last_cycle是否有效,第一个采样对只记录时间不积分
+} power_meter_t;
+
+// 初始化功率计
+void power_meter_init(power_meter_t* meter, uint16_t size, float v_k, float v_b, float i_k, float i_b);
+
+// 更新一个采样对,累加瞬时功率和能量
+void power_meter_update(power_meter_t* meter, uint16_t v_raw, uint16_t i_raw);
+
+// 更新一个DMA数据块内的n个采样对
+void power_meter_update_block(power_meter_t* meter, const uint16_t* v_raw, uint16_t v_stride, const uint16_t* i_raw, uint16_t i_stride, uint16_t n);
+
+// 窗口内逐采样对功率的均值,单位W
+float power_meter_get_power(const power_meter_t* meter);
+
+// 复位以来的累计能量,单位J
+float power_meter_get_energy(const power_meter_t* meter);
+
+// 清零累计能量
+void power_meter_reset_energy(power_meter_t* meter);
+
+#endif // !__POWER_METER_H__
@@ -36,7 +36,10 @@
  *************************************************************************************/
 #include "analog_signal.h"
 #include "mean_filter.h"
+#include "power_meter.h"
 #include "adc.h"
+#include "fsbb_pwm.h"
+#include <math.h>
 
 // 定义数据类型和结构体
 typedef struct
@@ -47,7 +50,7 @@ typedef struct
 
 typedef struct
 {
-    uint32_t stm32id[3];         // 96 bit stm32 id
+    uint32_t stm32id[3];         // 96 bit stm32 id,高位在前:{UIDw2, UIDw1, UIDw0}
     adc_calibration_t v_motor; // motor电压线性拟合数据
     adc_calibration_t i_chassis; // chassis电流线性拟合数据
     adc_calibration_t v_cap;     // cap电压线性拟合数据
@@ -74,69 +77,484 @@ static board_adc_calibration_t adc_cali_array[] = {
     // board_adc_calibration insert stop
 };
 
-#define ADC1_DATA_LEN (1U)
-#define ADC2_DATA_LEN (2U)
-#define ADC3_DATA_LEN (1U)
+// 当前板子的校准数据,启动时按UID解析一次,热路径只通过这个指针读取
+static const board_adc_calibration_t *adc_cali = &adc_cali_array[0];
+// 没有找到匹配UID的校准数据,使用默认(第0个)校准数据
+static uint8_t adc_cali_is_default = 1;
 
-uint16_t adc1_data[ADC1_DATA_LEN * 2] = {0};
-uint16_t adc2_data[ADC2_DATA_LEN * 2] = {0};
-uint16_t adc3_data[ADC3_DATA_LEN * 2] = {0};
+// 每次触发转换的序列长度
+#define ADC1_SEQ_LEN (2U) // i_chassis, i_chassis
+#if (ADC_FAST_SEQUENCE)
+    #define ADC2_SEQ_LEN (2U) // i_cap, v_cap
+#else
+    #define ADC2_SEQ_LEN (4U) // i_cap, v_cap, i_cap, v_cap
+#endif
+#define ADC3_SEQ_LEN (2U) // v_motor, v_motor
 
-#define FILTER_WINDOW_SIZE 8 // 定义滤波窗口大小
+// 每个半缓冲(一个数据块)的长度
+#define ADC1_DATA_LEN (ADC1_SEQ_LEN * ADC_BLOCK_DEPTH)
+#define ADC2_DATA_LEN (ADC2_SEQ_LEN * ADC_BLOCK_DEPTH)
+#define ADC3_DATA_LEN (ADC3_SEQ_LEN * ADC_BLOCK_DEPTH)
 
-static mean_filter_t v_cap_filter = {0};
+// 按32位字读取做块内求和,缓冲区需要4字节对齐
+__ALIGNED(4) uint16_t adc1_data[ADC1_DATA_LEN * 2] = {0};
+__ALIGNED(4) uint16_t adc2_data[ADC2_DATA_LEN * 2] = {0};
+__ALIGNED(4) uint16_t adc3_data[ADC3_DATA_LEN * 2] = {0};
+
+#define FILTER_WINDOW_SIZE 8 // 定义滤波窗口大小,以样本数计
+
+// 各通道的采样时间,ADC_FAST_SEQUENCE时覆盖adc.c中的配置
+#if (ADC_FAST_SEQUENCE)
+    #define ADC_SIGNAL_SAMPLETIME ADC_SAMPLETIME_6CYCLES_5
+#else
+    #define ADC_SIGNAL_SAMPLETIME ADC_SAMPLETIME_92CYCLES_5
+#endif
+
+#if (ADC_CHASSIS_DUAL_SIMULT)
+    #define ADC3_DUAL_DATA_LEN (ADC_BLOCK_DEPTH) // 每个半缓冲的采样对数,低16位为ADC3(主),高16位为ADC4(从)
+
+static ADC_HandleTypeDef hadc4;
+uint32_t adc3_dual_data[ADC3_DUAL_DATA_LEN * 2] = {0};
+#endif
+
+// 功率计窗口至少容纳一个数据块内的全部采样对
+#define POWER_METER_WINDOW_SIZE(pairs) ((pairs) > FILTER_WINDOW_SIZE ? (pairs) : FILTER_WINDOW_SIZE)
+#if (ADC2_DATA_LEN / 2 > POWER_METER_MAX_WINDOW_SIZE)
+    #error "ADC_BLOCK_DEPTH too large for power meter window"
+#endif
+
+static CCMRAM_DATA mean_filter_t v_cap_filter = {0};
 // static mean_filter_t v_chassis_filter = {0};
-static mean_filter_t i_cap_filter   = {0};
-static mean_filter_t v_motor_filter = {0};
+static CCMRAM_DATA mean_filter_t i_cap_filter   = {0};
+static CCMRAM_DATA mean_filter_t v_motor_filter = {0};
 // static mean_filter_t i_motor_filter   = {0};
-static mean_filter_t i_chassis_filter = {0};
+static CCMRAM_DATA mean_filter_t i_chassis_filter = {0};
+
+// 逐采样对的功率/能量统计,与开关周期同步的ADC采样每产生一个电压/电流对就更新一次
+static CCMRAM_DATA power_meter_t chassis_power_meter = {0};
+static CCMRAM_DATA power_meter_t cap_power_meter     = {0};
+// 触发过的模拟看门狗
+static volatile uint32_t adc_awd_trip_source = 0;
+// 阈值超出传感器测量范围、被收紧到量程内的模拟看门狗
+static uint32_t adc_awd_derated = 0;
+
+#define ADC_TRIP_MARGIN     (64.0f)    // 保护阈值距ADC量程两端的最小裕量,12位原始值,大于AWD2/AWD3的8位分辨率
+#define ADC_WATCHDOG_NO_LOW (-1000.0f) // 不检测下限,换算后限幅为原始值0
+
+#if !(ADC_CHASSIS_DUAL_SIMULT)
+static uint16_t v_motor_raw_latest = 0; // 底盘电压与电流不同步时,电流采样与最近一个电压数据块的均值配对
+#endif
+
+// 定点线性映射参数:value_q16 = ((sum * gain) >> shift) + offset
+// 直接作用于滤波窗口内的原始值总和,除以样本数折算进gain,不截断为12位平均值
+typedef struct
+{
+    int32_t gain;   // k / count * 2^(16 + shift)
+    int32_t offset; // b * 2^16
+    uint32_t shift; // gain的额外小数位数
+} adc_fixed_scale_t;
+
+static CCMRAM_DATA adc_fixed_scale_t v_motor_scale   = {0};
+static CCMRAM_DATA adc_fixed_scale_t v_cap_scale     = {0};
+static CCMRAM_DATA adc_fixed_scale_t i_chassis_scale = {0};
+static CCMRAM_DATA adc_fixed_scale_t i_cap_scale     = {0};
+
+/**************************************************************************************
+ * @brief   由校准数据和窗口内样本数计算定点线性映射参数,启动时调用一次。
+ *          gain取尽可能多的小数位且不超过2^30,sum与gain的乘积用64位保存。
+ *
+ * @param   scale       定点线性映射参数。
+ * @param   calibration 校准数据。
+ * @param   count       滤波窗口内的样本总数。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void adc_fixed_scale_init(adc_fixed_scale_t *scale, const adc_calibration_t *calibration, uint32_t count)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // 启动时只算一次,用双精度保留gain的全部30位有效位
+    double gain = (double)calibration->k / count * 65536.0;
+    int exp     = 0;
+    frexp(gain, &exp);
+
+    int shift = 30 - exp;
+    if (shift < 0) {
+        shift = 0;
+    } else if (shift > 48) {
+        shift = 48;
+    }
+
+    scale->gain   = (int32_t)lround(ldexp(gain, shift));
+    scale->offset = (int32_t)lround((double)calibration->b * 65536.0);
+    scale->shift  = (uint32_t)shift;
+}
+
+// 原始值总和映射为Q16定点数(16位小数)的实际值
+static inline int32_t adc_fixed_scale_apply(const adc_fixed_scale_t *scale, uint32_t sum)
+{
+    int64_t product = (int64_t)sum * scale->gain;
+    if (scale->shift > 0) {
+        product += (int64_t)1 << (scale->shift - 1); // 四舍五入
+    }
+    return (int32_t)(product >> scale->shift) + scale->offset;
+}
 
-// 线性映射,用于将ADC采样值映射到实际值
-static inline float linear_map(float value, adc_calibration_t calibration)
+CCMRAM_FUNC int32_t get_voltage_motor_q16()
 {
-    return calibration.k * value + calibration.b;
+    return adc_fixed_scale_apply(&v_motor_scale, mean_filter_get_sum(&v_motor_filter));
 }
 
-float get_voltage_motor()
+CCMRAM_FUNC int32_t get_voltage_cap_q16()
 {
-    uint16_t adc_value_average = mean_filter_calculate_average(&v_motor_filter);
-    float mapped_value         = linear_map(adc_value_average, adc_cali_array[0].v_motor);
-    return mapped_value;
+    return adc_fixed_scale_apply(&v_cap_scale, mean_filter_get_sum(&v_cap_filter));
 }
 
-float get_voltage_cap()
+CCMRAM_FUNC int32_t get_current_chassis_q16()
 {
-    uint16_t adc_value_average = mean_filter_calculate_average(&v_cap_filter);
-    float mapped_value         = linear_map(adc_value_average, adc_cali_array[0].v_cap);
-    return mapped_value;
+    return adc_fixed_scale_apply(&i_chassis_scale, mean_filter_get_sum(&i_chassis_filter));
 }
 
-float get_current_chassis()
+CCMRAM_FUNC int32_t get_current_cap_q16()
 {
-    uint16_t adc_value_average = mean_filter_calculate_average(&i_chassis_filter);
-    float mapped_value         = linear_map(adc_value_average, adc_cali_array[0].i_chassis);
-    return mapped_value;
+    return adc_fixed_scale_apply(&i_cap_scale, mean_filter_get_sum(&i_cap_filter));
+}
+
+CCMRAM_FUNC float get_voltage_motor()
+{
+    return get_voltage_motor_q16() * (1.0f / 65536.0f);
+}
+
+CCMRAM_FUNC float get_voltage_cap()
+{
+    return get_voltage_cap_q16() * (1.0f / 65536.0f);
+}
+
+CCMRAM_FUNC float get_current_chassis()
+{
+    return get_current_chassis_q16() * (1.0f / 65536.0f);
 }
 
 // float get_current_motor()
 // {
 //     uint16_t adc_value_average = mean_filter_calculate_average(&i_motor_filter);
-//     float    mapped_value      = linear_map(adc_value_average, adc_cali_array[0].i_motor);
+//     float    mapped_value      = linear_map(adc_value_average, adc_cali->i_motor);
 //     return mapped_value;
 // }
 
-float get_current_cap()
+/**************************************************************************************
+ * @brief   获取底盘功率,即窗口内逐采样对功率 v[n]·i[n] 的均值。
+ *          同步采样模式下电压/电流来自同一时刻,否则电流采样与最近一次电压采样配对。
+ *
+ * @return  float   底盘功率,单位W
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC float get_power_chassis()
+{
+    return power_meter_get_power(&chassis_power_meter);
+}
+
+// 电容功率,窗口内逐采样对功率的均值
+float get_power_cap()
+{
+    return power_meter_get_power(&cap_power_meter);
+}
+
+// 底盘端复位以来的累计能量,单位J
+float get_energy_chassis()
+{
+    return power_meter_get_energy(&chassis_power_meter);
+}
+
+// 电容端复位以来的累计能量,单位J
+float get_energy_cap()
+{
+    return power_meter_get_energy(&cap_power_meter);
+}
+
+void reset_energy()
+{
+    power_meter_reset_energy(&chassis_power_meter);
+    power_meter_reset_energy(&cap_power_meter);
+}
+
+CCMRAM_FUNC float get_current_cap()
+{
+    return get_current_cap_q16() * (1.0f / 65536.0f);
+}
+
+#if (ADC_FAST_SEQUENCE)
+// 按通道设置一个序列位置的采样时间,同一通道在序列中的其他位置共用这个采样时间
+static void adc_sampling_config(ADC_HandleTypeDef *hadc, uint32_t channel, uint32_t rank)
+{
+    ADC_ChannelConfTypeDef sConfig = {0};
+
+    sConfig.Channel      = channel;
+    sConfig.Rank         = rank;
+    sConfig.SamplingTime = ADC_SIGNAL_SAMPLETIME;
+    sConfig.SingleDiff   = ADC_SINGLE_ENDED;
+    sConfig.OffsetNumber = ADC_OFFSET_NONE;
+    sConfig.Offset       = 0;
+    if (HAL_ADC_ConfigChannel(hadc, &sConfig) != HAL_OK) {
+        Error_Handler();
+    }
+}
+
+// 缩短序列转换时间,使序列在几个开关周期的ADC触发间隔内完成
+static void adc_fast_sequence_init(void)
+{
+    // ADC2只保留第一个电流/电压对,后两个位置不再转换
+    hadc2.Init.NbrOfConversion = ADC2_SEQ_LEN;
+    if (HAL_ADC_Init(&hadc2) != HAL_OK) {
+        Error_Handler();
+    }
+
+    adc_sampling_config(&hadc1, ADC_CHANNEL_11, ADC_REGULAR_RANK_1);
+    adc_sampling_config(&hadc2, ADC_CHANNEL_12, ADC_REGULAR_RANK_1);
+    adc_sampling_config(&hadc2, ADC_CHANNEL_13, ADC_REGULAR_RANK_2);
+    adc_sampling_config(&hadc3, ADC_CHANNEL_5, ADC_REGULAR_RANK_1);
+}
+#endif
+
+#if (ADC_CHASSIS_DUAL_SIMULT)
+// ADC3(主)/ADC4(从)双重规则同步模式,同一触发同时采样底盘电压和底盘电流
+static void adc_chassis_dual_init(void)
+{
+    ADC_MultiModeTypeDef multimode = {0};
+    ADC_ChannelConfTypeDef sConfig = {0};
+
+    // 每次触发只转换一个采样对,保证序列在一个ADC触发周期内完成
+    hadc3.Init.NbrOfConversion = 1;
+    if (HAL_ADC_Init(&hadc3) != HAL_OK) {
+        Error_Handler();
+    }
+
+    // 从ADC的转换参数必须与主ADC一致,触发由主ADC提供
+    hadc4.Instance                   = ADC4;
+    hadc4.Init                       = hadc3.Init;
+    hadc4.Init.ExternalTrigConv      = ADC_SOFTWARE_START;
+    hadc4.Init.DMAContinuousRequests = DISABLE;
+    if (HAL_ADC_Init(&hadc4) != HAL_OK) {
+        Error_Handler();
+    }
+
+    // PB12 ------> ADC4_IN3,与ADC3_IN5同一采样时间
+    sConfig.Channel      = ADC_CHANNEL_3;
+    sConfig.Rank         = ADC_REGULAR_RANK_1;
+    sConfig.SamplingTime = ADC_SIGNAL_SAMPLETIME;
+    sConfig.SingleDiff   = ADC_SINGLE_ENDED;
+    sConfig.OffsetNumber = ADC_OFFSET_NONE;
+    sConfig.Offset       = 0;
+    if (HAL_ADC_ConfigChannel(&hadc4, &sConfig) != HAL_OK) {
+        Error_Handler();
+    }
+
+    multimode.Mode             = ADC_DUALMODE_REGSIMULT;
+    multimode.DMAAccessMode    = ADC_DMAACCESSMODE_12_10_BITS;
+    multimode.TwoSamplingDelay = ADC_TWOSAMPLINGDELAY_1CYCLE;
+    if (HAL_ADCEx_MultiModeConfigChannel(&hadc3, &multimode) != HAL_OK) {
+        Error_Handler();
+    }
+
+    // 双重模式下主ADC的DMA每次从CDR搬运32位
+    hadc3.DMA_Handle->Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    hadc3.DMA_Handle->Init.MemDataAlignment    = DMA_MDATAALIGN_WORD;
+    if (HAL_DMA_Init(hadc3.DMA_Handle) != HAL_OK) {
+        Error_Handler();
+    }
+}
+#endif
+
+/**************************************************************************************
+ * @brief   按芯片的96位UID在校准表中查找本板的校准数据,结果缓存在adc_cali中。
+ *          没有匹配项时使用第0个校准数据,并置位adc_cali_is_default,通过CAN上报。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void adc_calibration_resolve(void)
+{
+    const uint32_t uid[3] = {HAL_GetUIDw2(), HAL_GetUIDw1(), HAL_GetUIDw0()};
+
+    adc_cali            = &adc_cali_array[0];
+    adc_cali_is_default = 1;
+
+    for (uint32_t n = 0; n < sizeof(adc_cali_array) / sizeof(adc_cali_array[0]); n++) {
+        if (adc_cali_array[n].stm32id[0] == uid[0] &&
+            adc_cali_array[n].stm32id[1] == uid[1] &&
+            adc_cali_array[n].stm32id[2] == uid[2]) {
+            adc_cali            = &adc_cali_array[n];
+            adc_cali_is_default = 0;
+            break;
+        }
+    }
+}
+
+// 是否在使用默认校准数据
+uint8_t get_adc_calibration_is_default()
 {
-    uint16_t adc_value_average = mean_filter_calculate_average(&i_cap_filter);
-    float mapped_value         = linear_map(adc_value_average, adc_cali_array[0].i_cap);
-    return mapped_value;
+    return adc_cali_is_default;
+}
+
+// 模拟信号通道在当前板子上的校准数据
+static const adc_calibration_t *adc_signal_calibration(adc_signal_t signal)
+{
+    switch (signal) {
+        case ADC_SIGNAL_V_MOTOR:
+            return &adc_cali->v_motor;
+        case ADC_SIGNAL_I_CHASSIS:
+            return &adc_cali->i_chassis;
+        case ADC_SIGNAL_V_CAP:
+            return &adc_cali->v_cap;
+        case ADC_SIGNAL_I_CAP:
+        default:
+            return &adc_cali->i_cap;
+    }
+}
+
+/**************************************************************************************
+ * @brief   按当前板子的校准数据把实际值换算为12位原始值(单次转换,不含过采样),
+ *          用于DAC比较阈值等与ADC共用参考电压的场合。超出量程的结果被限幅,
+ *          保护阈值需要先经get_adc_trip_limit收紧到量程内。
+ *
+ * @param   signal  模拟信号通道。
+ * @param   value   实际值,单位V/A。
+ * @return  12位原始值。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+uint16_t get_adc_raw_from_value(adc_signal_t signal, float value)
+{
+    const adc_calibration_t *calibration = adc_signal_calibration(signal);
+
+    // 校准数据对应16倍过采样和
+    float raw = (value - calibration->b) / calibration->k / 16.0f;
+    raw       = (raw < 0.0f) ? 0.0f : (raw > 4095.0f) ? 4095.0f : raw;
+    return (uint16_t)(raw + 0.5f);
+}
+
+/**************************************************************************************
+ * @brief   把保护阈值限制在传感器的测量范围内:换算到12位原始值后距量程两端至少ADC_TRIP_MARGIN。
+ *          传感器饱和在量程端点时,超出量程的阈值永远不会触发,收紧后在饱和之前一定能触发。
+ *
+ * @param   signal  模拟信号通道。
+ * @param   value   实际值阈值,单位V/A。
+ * @return  测量范围内的阈值,value在范围内时原样返回。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+float get_adc_trip_limit(adc_signal_t signal, float value)
+{
+    const adc_calibration_t *calibration = adc_signal_calibration(signal);
+
+    // 校准数据对应16倍过采样和
+    float edge_a = calibration->k * 16.0f * ADC_TRIP_MARGIN + calibration->b;
+    float edge_b = calibration->k * 16.0f * (4095.0f - ADC_TRIP_MARGIN) + calibration->b;
+    float min    = fminf(edge_a, edge_b);
+    float max    = fmaxf(edge_a, edge_b);
+
+    return (value < min) ? min : (value > max) ? max : value;
+}
+
+/**************************************************************************************
+ * @brief   配置一个模拟看门狗,阈值由实际值按当前板子的校准数据换算。
+ *          开启16倍过采样时看门狗比较的是过采样和的高12位,即 原始值和 / 16;
+ *          AWD2/AWD3只比较高8位,HAL会把12位阈值右移4位。
+ *          阈值需要先经adc_trip_limit收紧到量程内,只有ADC_WATCHDOG_NO_LOW会被限幅到0。
+ *
+ * @param   hadc        ADC句柄。
+ * @param   watchdog    ADC_ANALOGWATCHDOG_1/2/3。
+ * @param   channel     被监测的规则通道。
+ * @param   calibration 该通道的校准数据。
+ * @param   low         实际值下限。
+ * @param   high        实际值上限。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void adc_watchdog_config(ADC_HandleTypeDef *hadc, uint32_t watchdog, uint32_t channel,
+                                const adc_calibration_t *calibration, float low, float high)
+{
+    ADC_AnalogWDGConfTypeDef awd = {0};
+
+    float raw_low  = (low - calibration->b) / calibration->k / 16.0f;
+    float raw_high = (high - calibration->b) / calibration->k / 16.0f;
+    if (raw_low > raw_high) {
+        float tmp = raw_low;
+        raw_low   = raw_high;
+        raw_high  = tmp;
+    }
+    raw_low  = (raw_low < 0.0f) ? 0.0f : (raw_low > 4095.0f) ? 4095.0f : raw_low;
+    raw_high = (raw_high < 0.0f) ? 0.0f : (raw_high > 4095.0f) ? 4095.0f : raw_high;
+
+    awd.WatchdogNumber  = watchdog;
+    awd.WatchdogMode    = ADC_ANALOGWATCHDOG_SINGLE_REG;
+    awd.Channel         = channel;
+    awd.ITMode          = ENABLE;
+    awd.HighThreshold   = (uint32_t)raw_high;
+    awd.LowThreshold    = (uint32_t)raw_low;
+    awd.FilteringConfig = ADC_AWD_FILTERING_NONE;
+    if (HAL_ADC_AnalogWDGConfig(hadc, &awd) != HAL_OK) {
+        Error_Handler();
+    }
+}
+
+// 收紧到测量范围内的保护阈值,被收紧时在adc_awd_derated中记录对应通道
+static float adc_trip_limit(adc_signal_t signal, float value, uint32_t source)
+{
+    float limit = get_adc_trip_limit(signal, value);
+    if (limit != value) {
+        adc_awd_derated |= source;
+    }
+    return limit;
+}
+
+// 电容电压、电容电流、底盘电压的硬件过压/过流保护
+static void adc_watchdog_init(void)
+{
+    float v_cap_high   = adc_trip_limit(ADC_SIGNAL_V_CAP, CAP_VOLTAGE_TRIP, ADC_AWD_TRIP_V_CAP);
+    float i_cap_low    = adc_trip_limit(ADC_SIGNAL_I_CAP, -CAP_CURRENT_TRIP, ADC_AWD_TRIP_I_CAP);
+    float i_cap_high   = adc_trip_limit(ADC_SIGNAL_I_CAP, CAP_CURRENT_TRIP, ADC_AWD_TRIP_I_CAP);
+    float v_motor_high = adc_trip_limit(ADC_SIGNAL_V_MOTOR, MOTOR_VOLTAGE_TRIP, ADC_AWD_TRIP_V_MOTOR);
+
+    adc_watchdog_config(&hadc2, ADC_ANALOGWATCHDOG_1, ADC_CHANNEL_13, &adc_cali->v_cap, ADC_WATCHDOG_NO_LOW, v_cap_high);
+    adc_watchdog_config(&hadc2, ADC_ANALOGWATCHDOG_2, ADC_CHANNEL_12, &adc_cali->i_cap, i_cap_low, i_cap_high);
+    adc_watchdog_config(&hadc3, ADC_ANALOGWATCHDOG_1, ADC_CHANNEL_5, &adc_cali->v_motor, ADC_WATCHDOG_NO_LOW, v_motor_high);
 }
 
 void BSP_ADC_Convert_Start(void)
 {
+    adc_calibration_resolve();
+
+    // 功率计在DMA启动前初始化,第一个采样对就能参与统计
+#if (ADC_CHASSIS_DUAL_SIMULT)
+    power_meter_init(&chassis_power_meter, POWER_METER_WINDOW_SIZE(ADC3_DUAL_DATA_LEN),
+#else
+    power_meter_init(&chassis_power_meter, POWER_METER_WINDOW_SIZE(ADC1_DATA_LEN),
+#endif
+                     adc_cali->v_motor.k, adc_cali->v_motor.b,
+                     adc_cali->i_chassis.k, adc_cali->i_chassis.b);
+    power_meter_init(&cap_power_meter, POWER_METER_WINDOW_SIZE(ADC2_DATA_LEN / 2),
+                     adc_cali->v_cap.k, adc_cali->v_cap.b,
+                     adc_cali->i_cap.k, adc_cali->i_cap.b);
+
+#if (ADC_FAST_SEQUENCE)
+    adc_fast_sequence_init();
+#endif
+
+#if (ADC_CHASSIS_DUAL_SIMULT)
+    // 底盘电流改由ADC4采样,ADC1不再启动,避免两个ADC同时对PB12采样
+    adc_chassis_dual_init();
+#else
     HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED);
     HAL_Delay(5);
     HAL_ADC_Start_DMA(&hadc1, (uint32_t *)adc1_data, ADC1_DATA_LEN * 2);
+#endif
+
+    // 模拟看门狗在ADC启动前配置,ADC3在同步采样模式下已重新初始化
+    adc_watchdog_init();
 
     HAL_ADCEx_Calibration_Start(&hadc2, ADC_SINGLE_ENDED);
     HAL_Delay(5);
@@ -144,35 +562,282 @@ void BSP_ADC_Convert_Start(void)
 
     HAL_ADCEx_Calibration_Start(&hadc3, ADC_SINGLE_ENDED);
     HAL_Delay(5);
+#if (ADC_CHASSIS_DUAL_SIMULT)
+    HAL_ADCEx_Calibration_Start(&hadc4, ADC_SINGLE_ENDED);
+    HAL_Delay(5);
+    HAL_ADCEx_MultiModeStart_DMA(&hadc3, adc3_dual_data, ADC3_DUAL_DATA_LEN * 2);
+#else
     HAL_ADC_Start_DMA(&hadc3, (uint32_t *)adc3_data, ADC3_DATA_LEN * 2);
+#endif
 
-    mean_filter_init(&v_cap_filter, FILTER_WINDOW_SIZE);
-    mean_filter_init(&v_motor_filter, FILTER_WINDOW_SIZE);
-    mean_filter_init(&i_cap_filter, FILTER_WINDOW_SIZE);
+    // 数据只通过DMA中断处理,ADC自身的溢出中断不需要,ADC中断只保留模拟看门狗。
+    // 看门狗中断设为最高优先级,ADC的DMA中断降一级,使保护动作可以抢占数据块处理和控制环
+    __HAL_ADC_DISABLE_IT(&hadc1, ADC_IT_OVR);
+    __HAL_ADC_DISABLE_IT(&hadc2, ADC_IT_OVR);
+    __HAL_ADC_DISABLE_IT(&hadc3, ADC_IT_OVR);
+    HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, 1, 0);
+    HAL_NVIC_SetPriority(DMA1_Channel2_IRQn, 1, 0);
+    HAL_NVIC_SetPriority(DMA1_Channel3_IRQn, 1, 0);
+    HAL_NVIC_SetPriority(ADC1_2_IRQn, 0, 0);
+    HAL_NVIC_SetPriority(ADC3_IRQn, 0, 0);
+
+    // 窗口中的每个元素是一个数据块内该通道样本的和
+    mean_filter_init_block(&v_cap_filter, FILTER_WINDOW_SIZE, ADC2_DATA_LEN / 2);
+    mean_filter_init_block(&i_cap_filter, FILTER_WINDOW_SIZE, ADC2_DATA_LEN / 2);
     // mean_filter_init(&i_motor_filter, FILTER_WINDOW_SIZE);
-    mean_filter_init(&i_chassis_filter, 32);
+#if (ADC_CHASSIS_DUAL_SIMULT)
+    // 同步采样的电压/电流使用相同的窗口长度
+    mean_filter_init_block(&v_motor_filter, FILTER_WINDOW_SIZE, ADC3_DUAL_DATA_LEN);
+    mean_filter_init_block(&i_chassis_filter, FILTER_WINDOW_SIZE, ADC3_DUAL_DATA_LEN);
+#else
+    mean_filter_init_block(&v_motor_filter, FILTER_WINDOW_SIZE, ADC3_DATA_LEN);
+    mean_filter_init_block(&i_chassis_filter, 32, ADC1_DATA_LEN);
+#endif
+
+    adc_fixed_scale_init(&v_motor_scale, &adc_cali->v_motor, mean_filter_get_count(&v_motor_filter));
+    adc_fixed_scale_init(&v_cap_scale, &adc_cali->v_cap, mean_filter_get_count(&v_cap_filter));
+    adc_fixed_scale_init(&i_chassis_scale, &adc_cali->i_chassis, mean_filter_get_count(&i_chassis_filter));
+    adc_fixed_scale_init(&i_cap_scale, &adc_cali->i_cap, mean_filter_get_count(&i_cap_filter));
+}
+
+/**************************************************************************************
+ * @brief   底盘侧ADC序列转换完成回调(弱定义)。
+ *          ADC1(同步采样模式下为ADC3/ADC4)由HRTIM_TRG1(主定时器周期)触发,
+ *          序列结束的时刻相对开关周期是固定的,需要与开关周期锁相的控制环可以重写此函数。
+ *          每个DMA数据块(ADC_BLOCK_DEPTH次序列转换)结束时调用一次。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+__weak void BSP_ADC_SequenceCpltCallback(void)
+{
 }
 
-void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+/**************************************************************************************
+ * @brief   模拟看门狗越限回调(弱定义),在最高优先级的ADC中断中调用,应立即关闭功率输出。
+ *
+ * @param   source  越限的通道,ADC_AWD_TRIP_xxx的组合。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+__weak void BSP_ADC_WatchdogCallback(uint32_t source)
+{
+}
+
+// 读取并清除一个ADC已使能的看门狗标志
+static inline uint32_t adc_watchdog_flags(ADC_TypeDef *adc)
+{
+    uint32_t flags = adc->ISR & adc->IER & (ADC_ISR_AWD1 | ADC_ISR_AWD2 | ADC_ISR_AWD3);
+    adc->ISR       = flags;
+    return flags;
+}
+
+/**************************************************************************************
+ * @brief   ADC中断入口,由stm32g4xx_it.c中的ADC1_2_IRQHandler和ADC3_IRQHandler调用。
+ *          ADC中断只使能了模拟看门狗,直接读写ISR,不经过HAL_ADC_IRQHandler。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC void BSP_ADC_Watchdog_IRQHandler(void)
+{
+    uint32_t source = 0;
+    uint32_t flags  = adc_watchdog_flags(ADC2);
+
+    if (flags & ADC_ISR_AWD1) {
+        source |= ADC_AWD_TRIP_V_CAP;
+    }
+    if (flags & ADC_ISR_AWD2) {
+        source |= ADC_AWD_TRIP_I_CAP;
+    }
+    if (adc_watchdog_flags(ADC3) & ADC_ISR_AWD1) {
+        source |= ADC_AWD_TRIP_V_MOTOR;
+    }
+
+    if (source) {
+        adc_awd_trip_source |= source;
+        BSP_ADC_WatchdogCallback(source);
+    }
+}
+
+// 复位以来触发过的看门狗,ADC_AWD_TRIP_xxx的组合
+uint32_t get_adc_watchdog_trip_source()
+{
+    return adc_awd_trip_source;
+}
+
+// 阈值超出传感器测量范围、实际在更低的值触发的看门狗,ADC_AWD_TRIP_xxx的组合
+uint32_t get_adc_watchdog_derated()
+{
+    return adc_awd_derated;
+}
+
+/**************************************************************************************
+ * @brief   对一个数据块内两路交织的16位样本分别求和。
+ *          按32位字读取,一次取出相邻两个样本,低半字和高半字各自累加,
+ *          两路交织的通道(i_cap/v_cap、双重模式的v_motor/i_chassis)在求和时顺带完成分离;
+ *          单通道的数据块两路之和即为块内总和。
+ *          过采样后的原始值是16位无符号数,超出q15的表示范围,因此不使用arm_mean_q15。
+ *
+ * @param   words   数据块起始地址,4字节对齐。
+ * @param   n       32位字的数量。
+ * @param   sum_lo  低半字(偶数下标样本)的和。
+ * @param   sum_hi  高半字(奇数下标样本)的和。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static inline void adc_block_sum2(const uint32_t *words, uint32_t n, uint32_t *sum_lo, uint32_t *sum_hi)
+{
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+
+    for (uint32_t k = 0; k < n; k++) {
+        uint32_t w = words[k];
+        lo += w & 0xFFFF;
+        hi += w >> 16;
+    }
+
+    *sum_lo = lo;
+    *sum_hi = hi;
+}
+
+#if (ADC_CHASSIS_DUAL_SIMULT)
+// 处理一个同步采样数据块,每个32位字是一个采样对:低16位为电压(ADC3),高16位为电流(ADC4)
+static CCMRAM_FUNC void adc_chassis_dual_block(const uint32_t *block)
+{
+    uint32_t v_sum, i_sum;
+    adc_block_sum2(block, ADC3_DUAL_DATA_LEN, &v_sum, &i_sum);
+
+    mean_filter_update_block(&v_motor_filter, v_sum);
+    mean_filter_update_block(&i_chassis_filter, i_sum);
+    power_meter_update_block(&chassis_power_meter, (const uint16_t *)block, 2, (const uint16_t *)block + 1, 2, ADC3_DUAL_DATA_LEN);
+
+    BSP_ADC_SequenceCpltCallback();
+}
+#endif
+
+// 处理一个DMA数据块,block为0时是缓冲区前半部分(半传输完成),为1时是后半部分(传输完成)
+static CCMRAM_FUNC void adc1_block_process(uint32_t block)
+{
+    uint32_t sum_lo, sum_hi;
+    const uint16_t *data = &adc1_data[block * ADC1_DATA_LEN];
+
+    adc_block_sum2((const uint32_t *)data, ADC1_DATA_LEN / 2, &sum_lo, &sum_hi);
+    mean_filter_update_block(&i_chassis_filter, sum_lo + sum_hi);
+#if !(ADC_CHASSIS_DUAL_SIMULT)
+    power_meter_update_block(&chassis_power_meter, &v_motor_raw_latest, 0, data, 1, ADC1_DATA_LEN);
+#endif
+    BSP_ADC_SequenceCpltCallback();
+}
+
+static CCMRAM_FUNC void adc2_block_process(uint32_t block)
+{
+    uint32_t sum_lo, sum_hi;
+    const uint16_t *data = &adc2_data[block * ADC2_DATA_LEN];
+
+    adc_block_sum2((const uint32_t *)data, ADC2_DATA_LEN / 2, &sum_lo, &sum_hi);
+    mean_filter_update_block(&i_cap_filter, sum_lo);
+    mean_filter_update_block(&v_cap_filter, sum_hi);
+    power_meter_update_block(&cap_power_meter, data + 1, 2, data, 2, ADC2_DATA_LEN / 2);
+}
+
+static CCMRAM_FUNC void adc3_block_process(uint32_t block)
+{
+#if (ADC_CHASSIS_DUAL_SIMULT)
+    adc_chassis_dual_block(&adc3_dual_data[block * ADC3_DUAL_DATA_LEN]);
+#else
+    uint32_t sum_lo, sum_hi;
+
+    adc_block_sum2((const uint32_t *)&adc3_data[block * ADC3_DATA_LEN], ADC3_DATA_LEN / 2, &sum_lo, &sum_hi);
+    mean_filter_update_block(&v_motor_filter, sum_lo + sum_hi);
+    v_motor_raw_latest = (uint16_t)((sum_lo + sum_hi) / ADC3_DATA_LEN);
+#endif
+}
+
+#if (ADC_DMA_FAST_IRQ)
+/**************************************************************************************
+ * @brief   直接读取并清除DMA通道的中断标志,按标志处理对应的数据块。
+ *          半传输和传输完成标志同时置位时说明中断被推迟了一个数据块,两个数据块按顺序处理。
+ *
+ * @param   hdma        ADC对应的DMA句柄,只用于取得DMA基地址和通道标志位偏移。
+ * @param   process     该ADC的数据块处理函数。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static inline void adc_dma_irq_dispatch(const DMA_HandleTypeDef *hdma, void (*process)(uint32_t))
+{
+    uint32_t shift = hdma->ChannelIndex & 0x1FU;
+    uint32_t isr   = (hdma->DmaBaseAddress->ISR >> shift) & (DMA_ISR_HTIF1 | DMA_ISR_TCIF1 | DMA_ISR_TEIF1);
+
+    hdma->DmaBaseAddress->IFCR = isr << shift;
+
+    if (isr & DMA_ISR_TEIF1) {
+        Error_Handler();
+    }
+    if (isr & DMA_ISR_HTIF1) {
+        process(0);
+    }
+    if (isr & DMA_ISR_TCIF1) {
+        process(1);
+    }
+}
+
+// 寄存器级DMA中断入口,由stm32g4xx_it.c中的DMA1_Channel1/2/3_IRQHandler调用,不经过HAL的中断分发
+CCMRAM_FUNC void BSP_ADC1_DMA_IRQHandler(void)
+{
+    adc_dma_irq_dispatch(hadc1.DMA_Handle, adc1_block_process);
+}
+
+CCMRAM_FUNC void BSP_ADC2_DMA_IRQHandler(void)
+{
+    adc_dma_irq_dispatch(hadc2.DMA_Handle, adc2_block_process);
+}
+
+CCMRAM_FUNC void BSP_ADC3_DMA_IRQHandler(void)
+{
+    adc_dma_irq_dispatch(hadc3.DMA_Handle, adc3_block_process);
+}
+#else
+CCMRAM_FUNC void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
 {
     if (hadc->Instance == ADC1) {
-        mean_filter_update(&i_chassis_filter, adc1_data[0]);
+        adc1_block_process(0);
     } else if (hadc->Instance == ADC2) {
-        mean_filter_update(&i_cap_filter, adc2_data[0]);
-        mean_filter_update(&v_cap_filter, adc2_data[1]);
+        adc2_block_process(0);
     } else if (hadc->Instance == ADC3) {
-        mean_filter_update(&v_motor_filter, adc3_data[0]);
+        adc3_block_process(0);
     }
 }
 
-void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+CCMRAM_FUNC void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
 {
     if (hadc->Instance == ADC1) {
-        mean_filter_update(&i_chassis_filter, adc1_data[0 + ADC1_DATA_LEN]);
+        adc1_block_process(1);
     } else if (hadc->Instance == ADC2) {
-        mean_filter_update(&i_cap_filter, adc2_data[0 + ADC2_DATA_LEN]);
-        mean_filter_update(&v_cap_filter, adc2_data[1 + ADC2_DATA_LEN]);
+        adc2_block_process(1);
     } else if (hadc->Instance == ADC3) {
-        mean_filter_update(&v_motor_filter, adc3_data[0 + ADC3_DATA_LEN]);
+        adc3_block_process(1);
     }
 }
+#endif
+
+/**************************************************************************************
+ * @brief   底盘侧ADC的下一个DMA数据块是否已经就绪。
+ *          DMA中断在处理数据块前清除标志,在控制环结束时仍有标志置位,
+ *          说明下一次序列转换已经完成,控制环没有在一个触发周期内完成。
+ *
+ * @return  1为已就绪。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC uint8_t BSP_ADC_SequencePending(void)
+{
+#if (ADC_CHASSIS_DUAL_SIMULT)
+    const DMA_HandleTypeDef *hdma = hadc3.DMA_Handle;
+#else
+    const DMA_HandleTypeDef *hdma = hadc1.DMA_Handle;
+#endif
+    uint32_t shift = hdma->ChannelIndex & 0x1FU;
+
+    return ((hdma->DmaBaseAddress->ISR >> shift) & (DMA_ISR_HTIF1 | DMA_ISR_TCIF1)) ? 1 : 0;
+}
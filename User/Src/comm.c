@@ -1,7 +1,11 @@
 #include "comm.h"
 #include "fdcan.h"
 #include "analog_signal.h"
+#include "fsbb_pwm.h"
 #include "gpio.h"
+#include "cycle_profiler.h"
+#include "cpu_monitor.h"
+#include "fault_comp.h"
 #include <stdint.h>
 
 #define my_hfdcan hfdcan1
@@ -10,7 +14,13 @@ DcdcOutputState dcdc_output_state = DCDC_OUTPUT_OUTPUT_DISABLED;
 RxData can_rx_data                = {15, 0};
 TxData can_tx_data;
 
-static uint16_t can_recevie_cnt = 0;
+static uint16_t can_recevie_cnt      = 0;
+static uint16_t can_load_send_cnt    = 0;
+static uint16_t can_energy_send_cnt  = 0;
+static uint32_t can_overrun_reported = 0; // 已在状态帧中报告过的控制环超时次数
+#if (FSBB_BURST)
+static uint16_t can_burst_send_cnt = 0;
+#endif
 
 DcdcOutputState UpdateDcdcOutputState(uint8_t IsEnabled)
 {
@@ -122,13 +132,13 @@ void comm_init(void)
     HAL_FDCAN_Start(&my_hfdcan);
 }
 
-void can_send(void)
+// 发送一个8字节标准数据帧,发送FIFO满时丢弃
+static void can_send_frame(uint32_t identifier, uint8_t *data)
 {
     FDCAN_TxHeaderTypeDef TxHeader;
-    uint8_t data[8];
 
     // 设置消息头
-    TxHeader.Identifier          = SUPERCAP_ID; // 消息ID
+    TxHeader.Identifier          = identifier; // 消息ID
     TxHeader.IdType              = FDCAN_STANDARD_ID;
     TxHeader.TxFrameType         = FDCAN_DATA_FRAME;
     TxHeader.DataLength          = FDCAN_DLC_BYTES_8; // 数据长度码，这里是8字节
@@ -138,28 +148,35 @@ void can_send(void)
     TxHeader.TxEventFifoControl  = FDCAN_NO_TX_EVENTS;
     TxHeader.MessageMarker       = 0;
 
+    if (HAL_FDCAN_GetTxFifoFreeLevel(&my_hfdcan) > 0) {
+        HAL_FDCAN_AddMessageToTxFifoQ(&my_hfdcan, &TxHeader, data);
+    }
+}
+
+void can_send(void)
+{
+    CYCLE_PROFILER_BEGIN();
+    uint8_t data[8];
+
     // 获取数据
     float chassis_power_temp    = 0.0f;
     float motor_power_temp      = 0.0f;
     float supercap_power_temp   = 0.0f;
     float supercap_voltage_temp = 0.0f;
-    float supercap_current_temp = 0.0f;
     float chassis_voltage_temp  = 0.0f;
-    float chassis_current_temp  = 0.0f;
 
     uint16_t motor_power;
     uint16_t supercap_voltage;
     uint16_t chassis_voltage;
 
     uint8_t IsDcdcEnabled = 0;
+    uint8_t flags         = 0;
 
     // 获取数据
     supercap_voltage_temp = get_voltage_cap();
     chassis_voltage_temp  = get_voltage_motor();
-    chassis_current_temp  = get_current_chassis();
-    supercap_current_temp = get_current_cap();
-    chassis_power_temp    = chassis_voltage_temp * chassis_current_temp;
-    supercap_power_temp   = supercap_voltage_temp * supercap_current_temp;
+    chassis_power_temp    = get_power_chassis();
+    supercap_power_temp   = get_power_cap();
     motor_power_temp      = chassis_power_temp - supercap_power_temp;
     // 将数据转换为uint16_t类型
     motor_power      = float2uint16_t(motor_power_temp, -100.0f, 400.0f, 16);
@@ -173,6 +190,24 @@ void can_send(void)
         IsDcdcEnabled = 0;
     }
 
+    if (get_adc_calibration_is_default()) {
+        flags |= SUPERCAP_FLAG_CALI_DEFAULT;
+    }
+    if (fsbb_pwm_fault_get()) {
+        flags |= SUPERCAP_FLAG_FAULT;
+    }
+    uint32_t overrun_count = get_loop_overrun_count();
+    if (overrun_count != can_overrun_reported) {
+        can_overrun_reported = overrun_count;
+        flags |= SUPERCAP_FLAG_OVERRUN;
+    }
+    if (fsbb_burst_get_state()) {
+        flags |= SUPERCAP_FLAG_BURST;
+    }
+    if (get_adc_watchdog_derated() || get_fault_comp_derated()) {
+        flags |= SUPERCAP_FLAG_TRIP_DERATED;
+    }
+
     // 将txData结构体中的数据转换为字节数组
     data[1] = (uint8_t)(motor_power >> 8);        // 高字节
     data[0] = (uint8_t)(motor_power & 0xFF);      // 低字节
@@ -181,17 +216,141 @@ void can_send(void)
     data[5] = (uint8_t)(chassis_voltage >> 8);    // 高字节
     data[4] = (uint8_t)(chassis_voltage & 0xFF);  // 低字节
     data[6] = IsDcdcEnabled;
-    data[7] = 0x00; // unused
+    data[7] = flags;
 
     // 发送数据
-    if (HAL_FDCAN_GetTxFifoFreeLevel(&my_hfdcan) > 0) {
-        HAL_FDCAN_AddMessageToTxFifoQ(&my_hfdcan, &TxHeader, data);
+    can_send_frame(SUPERCAP_ID, data);
+
+    CYCLE_PROFILER_END(CYCLE_PROBE_CAN_SEND);
+}
+
+/**************************************************************************************
+ * @brief   CPU占用率帧,每CAN_LOAD_SEND_DIV次调用发送一次。
+ *          data[0..1]最近一个窗口的占用率,data[2..3]上电以来的最大占用率,单位0.1%;
+ *          data[4..7]上电以来的控制环超时次数。低字节在前。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void can_send_load(void)
+{
+    can_load_send_cnt++;
+    if (can_load_send_cnt < CAN_LOAD_SEND_DIV) {
+        return;
     }
+    can_load_send_cnt = 0;
+
+    uint8_t data[8];
+    uint16_t load          = get_cpu_load();
+    uint16_t load_max      = get_cpu_load_max();
+    uint32_t overrun_count = get_loop_overrun_count();
+
+    data[0] = (uint8_t)(load & 0xFF);
+    data[1] = (uint8_t)(load >> 8);
+    data[2] = (uint8_t)(load_max & 0xFF);
+    data[3] = (uint8_t)(load_max >> 8);
+    data[4] = (uint8_t)(overrun_count & 0xFF);
+    data[5] = (uint8_t)((overrun_count >> 8) & 0xFF);
+    data[6] = (uint8_t)((overrun_count >> 16) & 0xFF);
+    data[7] = (uint8_t)(overrun_count >> 24);
+
+    can_send_frame(SUPERCAP_LOAD_ID, data);
+}
+
+#if (FSBB_BURST)
+// 限幅到int16_t的范围后取整
+static int16_t float2int16_t(float x)
+{
+    x = (x < -32768.0f) ? -32768.0f : (x > 32767.0f) ? 32767.0f : x;
+    return (int16_t)x;
+}
+
+/**************************************************************************************
+ * @brief   轻载突发模式统计帧,每CAN_BURST_SEND_DIV次调用发送一次。
+ *          data[0..1]最近一次进入突发模式前的净输入功率(底盘端 - 电容端,即底盘负载 + 变换器损耗),int16,单位10mW;
+ *          data[2..3]进入后第一个100ms内净输入功率的减少量,即实测节省的损耗,int16,单位mW;
+ *          data[4..5]上一帧以来处于突发模式的时间比例,单位0.1%;
+ *          data[6..7]上电以来进入突发模式的次数。低字节在前。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void can_send_burst(void)
+{
+    can_burst_send_cnt++;
+    if (can_burst_send_cnt < CAN_BURST_SEND_DIV) {
+        return;
+    }
+    can_burst_send_cnt = 0;
+
+    uint8_t data[8];
+    float power_base, power_saved;
+    fsbb_burst_get_power(&power_base, &power_saved);
+    int16_t base       = float2int16_t(power_base * 100.0f);
+    int16_t saved      = float2int16_t(power_saved * 1000.0f);
+    uint16_t residency = fsbb_burst_get_residency();
+    uint16_t entries   = (uint16_t)fsbb_burst_get_entries();
+
+    data[0] = (uint8_t)((uint16_t)base & 0xFF);
+    data[1] = (uint8_t)((uint16_t)base >> 8);
+    data[2] = (uint8_t)((uint16_t)saved & 0xFF);
+    data[3] = (uint8_t)((uint16_t)saved >> 8);
+    data[4] = (uint8_t)(residency & 0xFF);
+    data[5] = (uint8_t)(residency >> 8);
+    data[6] = (uint8_t)(entries & 0xFF);
+    data[7] = (uint8_t)(entries >> 8);
+
+    can_send_frame(SUPERCAP_BURST_ID, data);
+}
+#endif
+
+/**************************************************************************************
+ * @brief   累计能量帧,每CAN_ENERGY_SEND_DIV次调用发送一次。
+ *          data[0..3]底盘端累计能量,data[4..7]电容端累计能量(充电为正),int32,单位mJ,低字节在前。
+ *          两者都从最近一次开启输出时开始累计,上位机可以据此做缓冲能量的预算。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void can_send_energy(void)
+{
+    can_energy_send_cnt++;
+    if (can_energy_send_cnt < CAN_ENERGY_SEND_DIV) {
+        return;
+    }
+    can_energy_send_cnt = 0;
+
+    uint8_t data[8];
+    int32_t energy_chassis = (int32_t)(get_energy_chassis() * 1000.0f);
+    int32_t energy_cap     = (int32_t)(get_energy_cap() * 1000.0f);
+
+    data[0] = (uint8_t)((uint32_t)energy_chassis & 0xFF);
+    data[1] = (uint8_t)(((uint32_t)energy_chassis >> 8) & 0xFF);
+    data[2] = (uint8_t)(((uint32_t)energy_chassis >> 16) & 0xFF);
+    data[3] = (uint8_t)((uint32_t)energy_chassis >> 24);
+    data[4] = (uint8_t)((uint32_t)energy_cap & 0xFF);
+    data[5] = (uint8_t)(((uint32_t)energy_cap >> 8) & 0xFF);
+    data[6] = (uint8_t)(((uint32_t)energy_cap >> 16) & 0xFF);
+    data[7] = (uint8_t)((uint32_t)energy_cap >> 24);
+
+    can_send_frame(SUPERCAP_ENERGY_ID, data);
 }
 
+#if (CYCLE_PROFILER_ENABLE)
+// 执行周期统计帧,每次发送一个埋点的一页,帧格式见cycle_profiler_frame
+void can_send_profile(void)
+{
+    uint8_t data[8];
+
+    cycle_profiler_frame(data);
+    can_send_frame(SUPERCAP_PROFILE_ID, data);
+}
+#endif
+
 // FDCAN接收中断处理函数
 void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo0ITs)
 {
+    CYCLE_PROFILER_BEGIN();
 
     if (hfdcan->Instance == FDCAN1) {
         FDCAN_RxHeaderTypeDef RxHeader;
@@ -218,4 +377,6 @@ void HAL_FDCAN_RxFifo0Callback(FDCAN_HandleTypeDef *hfdcan, uint32_t RxFifo0ITs)
             }
         }
     }
+
+    CYCLE_PROFILER_END(CYCLE_PROBE_CAN_RX);
 }
\ No newline at end of file
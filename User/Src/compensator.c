@@ -0,0 +1,340 @@
+#include "compensator.h"
+#include "main.h"
+#include <math.h>
+#include <string.h>
+
+#define COMPENSATOR_PI (3.14159265f)
+
+// FMAC的功能码与存储区划分,256个16位字中只用到前48个
+#define FMAC_FUNC_LOAD_X1  (1U << FMAC_PARAM_FUNC_Pos)
+#define FMAC_FUNC_LOAD_X2  (2U << FMAC_PARAM_FUNC_Pos)
+#define FMAC_FUNC_LOAD_Y   (3U << FMAC_PARAM_FUNC_Pos)
+#define FMAC_FUNC_IIR      (9U << FMAC_PARAM_FUNC_Pos)
+#define FMAC_X2_BASE       (0U)  // 系数b0~bN, a1~aN
+#define FMAC_X1_BASE       (16U) // 误差,N+2个
+#define FMAC_Y_BASE        (32U) // 输出,N+1个
+#define FMAC_GAIN_MAX      (7U)  // R的最大值
+#define FMAC_Q15_ONE       (32768.0f)
+#define FMAC_FEEDBACK_TOL  (1e-4f)  // 反馈系数之和与1的允许偏差
+#define FMAC_WAIT_MAX      (1000U)  // 等待装载完成、复位完成、输出就绪的最大轮询次数,可能在中断中调用,不使用HAL_GetTick
+
+// 多项式相乘,按z^-1的升幂排列,out的长度为len_a + len_b - 1
+static void compensator_poly_mul(const float *poly_a, uint32_t len_a, const float *poly_b, uint32_t len_b, float *out)
+{
+    for (uint32_t n = 0; n < len_a + len_b - 1; n++) {
+        out[n] = 0.0f;
+    }
+    for (uint32_t i = 0; i < len_a; i++) {
+        for (uint32_t j = 0; j < len_b; j++) {
+            out[i + j] += poly_a[i] * poly_b[j];
+        }
+    }
+}
+
+// 一阶环节(1 + s/(2πf))经双线性变换后除去(1 + z^-1)的部分:(1 + c) + (1 - c)·z^-1, c = 2fs/(2πf)
+static void compensator_tustin_first_order(float f, float f_sample, float *poly)
+{
+    float c = 2.0f * f_sample / (2.0f * COMPENSATOR_PI * f);
+
+    poly[0] = 1.0f + c;
+    poly[1] = 1.0f - c;
+}
+
+/**************************************************************************************
+ * @brief   由z域传递函数设置补偿器系数:H(z) = num(z^-1) / den(z^-1),按z^-1的升幂排列。
+ *          以den[0]归一化后,b = num / den[0],a_k = -den[k] / den[0]。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void compensator_set(compensator_t *comp, uint8_t order, const float *num, const float *den, float min_output,
+                            float max_output)
+{
+    memset(comp, 0, sizeof(compensator_t));
+
+    comp->order      = order;
+    comp->backend    = COMPENSATOR_BACKEND_FLOAT;
+    comp->output_min = min_output;
+    comp->output_max = max_output;
+    for (uint32_t n = 0; n <= order; n++) {
+        comp->b[n] = num[n] / den[0];
+    }
+    for (uint32_t n = 1; n <= order; n++) {
+        comp->a[n - 1] = -den[n] / den[0];
+    }
+}
+
+/**************************************************************************************
+ * @brief   以增量式PID的参数初始化2p2z补偿器,与pid_kernel_t的计算结果一致:
+ *          b = {Kp + Ki + Kd, -(Kp + 2·Kd), Kd}, a = {1, 0}。
+ *
+ * @param   comp        补偿器
+ * @param   kp/ki/kd    增量式PID的比例、积分、微分系数(离散域,每次计算)
+ * @param   min_output  输出下限
+ * @param   max_output  输出上限
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void compensator_init_pid(compensator_t *comp, float kp, float ki, float kd, float min_output, float max_output)
+{
+    const float num[3] = {kp + ki + kd, -(kp + 2.0f * kd), kd};
+    const float den[3] = {1.0f, -1.0f, 0.0f};
+
+    compensator_set(comp, 2, num, den, min_output, max_output);
+}
+
+/**************************************************************************************
+ * @brief   初始化Type-II补偿器(2p2z):H(s) = k·(1 + s/ωz) / (s·(1 + s/ωp)),双线性变换离散化。
+ *
+ * @param   comp        补偿器
+ * @param   k           积分增益,1/s
+ * @param   f_zero      零点频率,Hz
+ * @param   f_pole      极点频率,Hz,需要低于f_sample/2
+ * @param   f_sample    补偿器的运行频率,Hz
+ * @param   min_output  输出下限
+ * @param   max_output  输出上限
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void compensator_init_type2(compensator_t *comp, float k, float f_zero, float f_pole, float f_sample, float min_output,
+                            float max_output)
+{
+    // 积分环节k/s变换为k/(2fs)·(1 + z^-1)/(1 - z^-1),与零点、极点的(1 + z^-1)因子约去后分子剩一个(1 + z^-1)
+    const float integrator[2] = {k / (2.0f * f_sample), k / (2.0f * f_sample)};
+    const float accumulate[2] = {1.0f, -1.0f};
+    float zero[2], pole[2];
+    float num[3], den[3];
+
+    compensator_tustin_first_order(f_zero, f_sample, zero);
+    compensator_tustin_first_order(f_pole, f_sample, pole);
+    compensator_poly_mul(integrator, 2, zero, 2, num);
+    compensator_poly_mul(accumulate, 2, pole, 2, den);
+
+    compensator_set(comp, 2, num, den, min_output, max_output);
+}
+
+/**************************************************************************************
+ * @brief   初始化Type-III补偿器(3p3z):
+ *          H(s) = k·(1 + s/ωz1)·(1 + s/ωz2) / (s·(1 + s/ωp1)·(1 + s/ωp2)),双线性变换离散化。
+ *
+ * @param   comp            补偿器
+ * @param   k               积分增益,1/s
+ * @param   f_zero1/f_zero2 零点频率,Hz
+ * @param   f_pole1/f_pole2 极点频率,Hz,需要低于f_sample/2
+ * @param   f_sample        补偿器的运行频率,Hz
+ * @param   min_output      输出下限
+ * @param   max_output      输出上限
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void compensator_init_type3(compensator_t *comp, float k, float f_zero1, float f_zero2, float f_pole1, float f_pole2,
+                            float f_sample, float min_output, float max_output)
+{
+    const float integrator[2] = {k / (2.0f * f_sample), k / (2.0f * f_sample)};
+    const float accumulate[2] = {1.0f, -1.0f};
+    float zero1[2], zero2[2], pole1[2], pole2[2];
+    float zeros[3], poles[3];
+    float num[4], den[4];
+
+    compensator_tustin_first_order(f_zero1, f_sample, zero1);
+    compensator_tustin_first_order(f_zero2, f_sample, zero2);
+    compensator_tustin_first_order(f_pole1, f_sample, pole1);
+    compensator_tustin_first_order(f_pole2, f_sample, pole2);
+    compensator_poly_mul(zero1, 2, zero2, 2, zeros);
+    compensator_poly_mul(pole1, 2, pole2, 2, poles);
+    compensator_poly_mul(integrator, 2, zeros, 3, num);
+    compensator_poly_mul(accumulate, 2, poles, 3, den);
+
+    compensator_set(comp, 3, num, den, min_output, max_output);
+}
+
+// 输出换算为q1.15,超出FMAC的表示范围时限幅
+static int16_t compensator_fmac_output_q15(const compensator_t *comp, float output)
+{
+    float y = (output - comp->out_offset) / comp->out_scale;
+
+    y = (y > 32767.0f) ? 32767.0f : (y < -32768.0f) ? -32768.0f : y;
+    return (int16_t)lrintf(y);
+}
+
+// 等待寄存器中的位被硬件清零,超时说明FMAC没有按配置运行
+static inline void compensator_fmac_wait(volatile uint32_t *reg, uint32_t mask)
+{
+    uint32_t count = 0;
+    while (*reg & mask) {
+        if (++count > FMAC_WAIT_MAX) {
+            Error_Handler();
+        }
+    }
+}
+
+// 装载一段数据到FMAC存储区,START在写满后由硬件清零
+static void compensator_fmac_load(uint32_t func, uint32_t p, uint32_t q, const int16_t *data, uint32_t n)
+{
+    FMAC->PARAM = func | (p << FMAC_PARAM_P_Pos) | (q << FMAC_PARAM_Q_Pos) | FMAC_PARAM_START;
+    for (uint32_t i = 0; i < n; i++) {
+        FMAC->WDATA = (uint16_t)data[i];
+    }
+    compensator_fmac_wait(&FMAC->PARAM, FMAC_PARAM_START);
+}
+
+// 复位FMAC的指针和状态,以output预装载输出历史并启动IIR,存储区中的系数保持不变
+static void compensator_fmac_start(const compensator_t *comp, float output)
+{
+    const uint32_t p                       = comp->order + 1U;
+    const uint32_t q                       = comp->order;
+    int16_t history[COMPENSATOR_ORDER_MAX] = {0};
+
+    FMAC->CR |= FMAC_CR_RESET;
+    compensator_fmac_wait(&FMAC->CR, FMAC_CR_RESET);
+
+    // 误差历史预装载p - 1个0,之后每写入一个误差计算一次输出
+    compensator_fmac_load(FMAC_FUNC_LOAD_X1, p - 1U, 0, history, p - 1U);
+    for (uint32_t n = 0; n < q; n++) {
+        history[n] = compensator_fmac_output_q15(comp, output);
+    }
+    compensator_fmac_load(FMAC_FUNC_LOAD_Y, q, 0, history, q);
+
+    FMAC->CR    = FMAC_CR_CLIPEN;
+    FMAC->PARAM = FMAC_FUNC_IIR | (p << FMAC_PARAM_P_Pos) | (q << FMAC_PARAM_Q_Pos) |
+                  ((uint32_t)comp->gain << FMAC_PARAM_R_Pos) | FMAC_PARAM_START;
+}
+
+/**************************************************************************************
+ * @brief   把补偿器切换到FMAC后端:换算q1.15系数并装载到FMAC,然后以当前输出复位。
+ *          误差按in_range归一化,输出的[output_min, output_max)映射到q1.15的[-1, 1),
+ *          系数统一缩小2^R倍使其落在[-1, 1)内,由FMAC在累加后左移R位还原。
+ *          输出历史只有16位,单次输出增量小于(output_max - output_min)/65536时被舍去,
+ *          积分增益很小的补偿器需要相应减小in_range。
+ *
+ * @param   comp        已设置系数的补偿器,反馈系数之和需要为1
+ * @param   in_range    误差的满量程,超出部分在写入FMAC前限幅
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void compensator_fmac_attach(compensator_t *comp, float in_range)
+{
+    float feedback_sum = 0.0f;
+    float b[COMPENSATOR_ORDER_MAX + 1];
+    float coeff_max = 0.0f;
+
+    for (uint32_t n = 0; n < comp->order; n++) {
+        feedback_sum += comp->a[n];
+    }
+    if ((comp->order < 2) || (comp->order > COMPENSATOR_ORDER_MAX) ||
+        (fabsf(feedback_sum - 1.0f) > FMAC_FEEDBACK_TOL) || (in_range <= 0.0f)) {
+        Error_Handler();
+    }
+
+    comp->in_scale   = FMAC_Q15_ONE / in_range;
+    comp->out_offset = (comp->output_max + comp->output_min) * 0.5f;
+    comp->out_scale  = (comp->output_max - comp->output_min) * 0.5f / FMAC_Q15_ONE;
+
+    // 归一化后的前馈系数,反馈系数不变
+    for (uint32_t n = 0; n <= comp->order; n++) {
+        b[n]      = comp->b[n] * in_range / ((comp->output_max - comp->output_min) * 0.5f);
+        coeff_max = fmaxf(coeff_max, fabsf(b[n]));
+    }
+    for (uint32_t n = 0; n < comp->order; n++) {
+        coeff_max = fmaxf(coeff_max, fabsf(comp->a[n]));
+    }
+
+    comp->gain = 0;
+    while (coeff_max >= (float)(1U << comp->gain) * (32767.0f / FMAC_Q15_ONE)) {
+        if (++comp->gain > FMAC_GAIN_MAX) {
+            Error_Handler();
+        }
+    }
+
+    // 系数依次为b0~bN, a1~aN,与HAL_FMAC_FilterConfig的装载顺序相同
+    int16_t coeff[2 * COMPENSATOR_ORDER_MAX + 1];
+    float   coeff_scale = FMAC_Q15_ONE / (float)(1U << comp->gain);
+    for (uint32_t n = 0; n <= comp->order; n++) {
+        comp->b_q15[n] = (int16_t)lrintf(b[n] * coeff_scale);
+        coeff[n]       = comp->b_q15[n];
+    }
+    for (uint32_t n = 0; n < comp->order; n++) {
+        comp->a_q15[n]               = (int16_t)lrintf(comp->a[n] * coeff_scale);
+        coeff[comp->order + 1U + n] = comp->a_q15[n];
+    }
+
+    const uint32_t p = comp->order + 1U;
+    const uint32_t q = comp->order;
+
+    __HAL_RCC_FMAC_CLK_ENABLE();
+    FMAC->CR = FMAC_CR_RESET;
+    compensator_fmac_wait(&FMAC->CR, FMAC_CR_RESET);
+    FMAC->X2BUFCFG = (FMAC_X2_BASE << FMAC_X2BUFCFG_X2_BASE_Pos) | ((p + q) << FMAC_X2BUFCFG_X2_BUF_SIZE_Pos);
+    FMAC->X1BUFCFG = (FMAC_X1_BASE << FMAC_X1BUFCFG_X1_BASE_Pos) | ((p + 1U) << FMAC_X1BUFCFG_X1_BUF_SIZE_Pos);
+    FMAC->YBUFCFG  = (FMAC_Y_BASE << FMAC_YBUFCFG_Y_BASE_Pos) | ((q + 1U) << FMAC_YBUFCFG_Y_BUF_SIZE_Pos);
+    compensator_fmac_load(FMAC_FUNC_LOAD_X2, p, q, coeff, p + q);
+
+    comp->backend = COMPENSATOR_BACKEND_FMAC;
+    compensator_reset(comp, comp->output);
+}
+
+/**************************************************************************************
+ * @brief   复位补偿器的历史,使其从output开始无扰动地运行:误差历史清零,输出历史全部设为output。
+ *          含积分环节的补偿器在误差为0时保持output不变。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void compensator_reset(compensator_t *comp, float output)
+{
+    output = (output > comp->output_max)   ? comp->output_max
+             : (output < comp->output_min) ? comp->output_min
+                                           : output;
+
+    for (uint32_t n = 0; n < COMPENSATOR_ORDER_MAX; n++) {
+        comp->e[n] = 0.0f;
+        comp->u[n] = output;
+    }
+    comp->output = output;
+
+    if (comp->backend == COMPENSATOR_BACKEND_FMAC) {
+        compensator_fmac_start(comp, output);
+    }
+}
+
+/**************************************************************************************
+ * @brief   计算一次补偿器输出。
+ *
+ * @param   comp    补偿器
+ * @param   error   本次误差(设定值 - 实际值)
+ * @return  float   限幅后的输出
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC float compensator_compute(compensator_t *comp, float error)
+{
+    float output;
+
+    if (comp->backend == COMPENSATOR_BACKEND_FMAC) {
+        // 写入误差后FMAC在P + Q个周期左右完成计算,输出经CLIPEN限幅后同时写回Y缓冲区作为反馈
+        float x = error * comp->in_scale;
+        x       = (x > 32767.0f) ? 32767.0f : (x < -32768.0f) ? -32768.0f : x;
+
+        FMAC->WDATA = (uint16_t)(int16_t)x;
+        compensator_fmac_wait(&FMAC->SR, FMAC_SR_YEMPTY);
+        output = comp->out_offset + (float)(int16_t)FMAC->RDATA * comp->out_scale;
+    } else {
+        output = comp->b[0] * error;
+        for (uint32_t n = 0; n < comp->order; n++) {
+            output += comp->b[n + 1] * comp->e[n] + comp->a[n] * comp->u[n];
+        }
+        output = (output > comp->output_max)   ? comp->output_max
+                 : (output < comp->output_min) ? comp->output_min
+                                               : output;
+
+        for (uint32_t n = comp->order - 1U; n > 0; n--) {
+            comp->e[n] = comp->e[n - 1];
+            comp->u[n] = comp->u[n - 1];
+        }
+        comp->e[0] = error;
+        comp->u[0] = output;
+    }
+
+    comp->output = output;
+    return output;
+}
@@ -0,0 +1,108 @@
+#include "cpu_monitor.h"
+
+#define CPU_MONITOR_CALIBRATE_NUM (16U) // 标定空闲循环耗时的迭代次数
+
+// 空闲循环
+static uint32_t cpu_idle_gap     = 0; // 一次空闲迭代的最大周期数,超过说明期间执行了中断
+static uint32_t cpu_idle_last    = 0; // 上一次空闲迭代的DWT周期计数
+static uint32_t cpu_idle_cycles  = 0; // 当前窗口内的空闲周期数
+static uint32_t cpu_window_start = 0; // 当前窗口开始的DWT周期计数
+static uint32_t cpu_window       = 0; // 窗口长度,CPU周期
+
+// 统计结果,只在空闲循环中写入
+static volatile uint16_t cpu_load     = 0;
+static volatile uint16_t cpu_load_max = 0;
+
+// 控制环超时次数,只在控制环所在的中断中写入
+static volatile uint32_t loop_overrun_count = 0;
+
+/**************************************************************************************
+ * @brief   初始化CPU占用率统计,在主循环开始前调用。
+ *          关中断执行若干次空闲迭代,取最长的一次的两倍作为判断空闲迭代被中断打断的门限。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void cpu_monitor_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    cpu_window = SystemCoreClock / 1000U * CPU_MONITOR_WINDOW_MS;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint32_t gap     = 0;
+    cpu_idle_gap     = UINT32_MAX;
+    cpu_idle_last    = DWT->CYCCNT;
+    cpu_window_start = cpu_idle_last;
+    for (uint32_t n = 0; n < CPU_MONITOR_CALIBRATE_NUM; n++) {
+        uint32_t start = DWT->CYCCNT;
+        cpu_monitor_idle();
+        uint32_t cycles = DWT->CYCCNT - start;
+        if (cycles > gap) {
+            gap = cycles;
+        }
+    }
+
+    cpu_idle_gap     = gap * 2U;
+    cpu_idle_cycles  = 0;
+    cpu_idle_last    = DWT->CYCCNT;
+    cpu_window_start = cpu_idle_last;
+
+    __set_PRIMASK(primask);
+}
+
+/**************************************************************************************
+ * @brief   空闲迭代,在主循环中反复调用。
+ *          相邻两次迭代的间隔不超过门限时计为空闲,超过时说明期间执行了中断,整段计为占用。
+ *          每个窗口结束时更新占用率,误差为每次中断至多一次空闲迭代的时间。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC void cpu_monitor_idle(void)
+{
+    uint32_t now   = DWT->CYCCNT;
+    uint32_t delta = now - cpu_idle_last;
+
+    cpu_idle_last = now;
+    if (delta <= cpu_idle_gap) {
+        cpu_idle_cycles += delta;
+    }
+
+    uint32_t elapsed = now - cpu_window_start;
+    if (elapsed >= cpu_window) {
+        uint32_t busy = (cpu_idle_cycles < elapsed) ? elapsed - cpu_idle_cycles : 0;
+        uint16_t load = (uint16_t)((uint64_t)busy * 1000U / elapsed);
+
+        cpu_load = load;
+        if (load > cpu_load_max) {
+            cpu_load_max = load;
+        }
+        cpu_idle_cycles  = 0;
+        cpu_window_start = now;
+    }
+}
+
+// 记录一次控制环超时:下一次触发在本次计算完成前到来,或进入时已被其他中断推迟
+CCMRAM_FUNC void cpu_monitor_overrun(void)
+{
+    loop_overrun_count++;
+}
+
+uint16_t get_cpu_load(void)
+{
+    return cpu_load;
+}
+
+uint16_t get_cpu_load_max(void)
+{
+    return cpu_load_max;
+}
+
+uint32_t get_loop_overrun_count(void)
+{
+    return loop_overrun_count;
+}
@@ -0,0 +1,146 @@
+#include "cycle_profiler.h"
+
+#if (CYCLE_PROFILER_ENABLE)
+
+#define CYCLE_PROFILER_PAGE_NUM      (4U) // 每个埋点的统计帧页数:1页最值和均值,3页直方图
+#define CYCLE_PROFILER_BINS_PER_PAGE (7U)
+
+static CCMRAM_DATA cycle_stats_t cycle_stats[CYCLE_PROBE_NUM] = {0};
+
+// 下一帧发送的埋点和页
+static uint8_t cycle_profiler_frame_probe = 0;
+static uint8_t cycle_profiler_frame_page  = 0;
+
+/**************************************************************************************
+ * @brief   打开DWT周期计数器并清空所有统计,需要在开启中断前调用。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void cycle_profiler_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    cycle_profiler_reset();
+}
+
+// 清空所有统计,统计会被中断同时更新,清空的瞬间可能丢失一次采样
+void cycle_profiler_reset(void)
+{
+    for (uint32_t n = 0; n < CYCLE_PROBE_NUM; n++) {
+        cycle_stats_t *stats = &cycle_stats[n];
+
+        stats->count = 0;
+        stats->min   = UINT32_MAX;
+        stats->max   = 0;
+        stats->sum   = 0;
+        for (uint32_t bin = 0; bin < CYCLE_PROFILER_BIN_NUM; bin++) {
+            stats->hist[bin] = 0;
+        }
+    }
+}
+
+/**************************************************************************************
+ * @brief   记录一次执行周期数,由CYCLE_PROFILER_END调用。
+ *          同一个埋点只在一个中断中记录,不需要关中断。
+ *
+ * @param   probe   埋点。
+ * @param   cycles  执行周期数。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC void cycle_profiler_record(cycle_probe_t probe, uint32_t cycles)
+{
+    cycle_stats_t *stats = &cycle_stats[probe];
+    uint32_t bin         = cycles >> CYCLE_PROFILER_BIN_SHIFT;
+
+    if (bin >= CYCLE_PROFILER_BIN_NUM) {
+        bin = CYCLE_PROFILER_BIN_NUM - 1;
+    }
+    if (cycles < stats->min) {
+        stats->min = cycles;
+    }
+    if (cycles > stats->max) {
+        stats->max = cycles;
+    }
+    stats->count++;
+    stats->sum += cycles;
+    stats->hist[bin]++;
+}
+
+const cycle_stats_t *cycle_profiler_get(cycle_probe_t probe)
+{
+    return &cycle_stats[probe];
+}
+
+uint32_t cycle_profiler_get_mean(cycle_probe_t probe)
+{
+    const cycle_stats_t *stats = &cycle_stats[probe];
+
+    if (stats->count == 0) {
+        return 0;
+    }
+    return (uint32_t)(stats->sum / stats->count);
+}
+
+static uint16_t cycle_profiler_saturate(uint32_t cycles)
+{
+    return (cycles > UINT16_MAX) ? UINT16_MAX : (uint16_t)cycles;
+}
+
+/**************************************************************************************
+ * @brief   生成一帧统计数据,每次调用依次输出下一个埋点的下一页。
+ *          data[0]低4位为埋点编号,高4位为页号。
+ *          第0页:data[1..2]最小值,data[3..4]最大值,data[5..6]均值,低字节在前,单位CPU周期,
+ *                超过65535时饱和;data[7]为采样次数的低8位,用于判断统计是否在更新。
+ *          第1~3页:data[1..7]依次为直方图区间的百分比,不为零的区间至少为1。
+ *
+ * @param   data    8字节的帧数据。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void cycle_profiler_frame(uint8_t data[8])
+{
+    const cycle_stats_t *stats = &cycle_stats[cycle_profiler_frame_probe];
+    uint8_t page               = cycle_profiler_frame_page;
+
+    data[0] = (uint8_t)(cycle_profiler_frame_probe | (page << 4));
+
+    if (page == 0) {
+        uint16_t min  = (stats->count == 0) ? 0 : cycle_profiler_saturate(stats->min);
+        uint16_t max  = cycle_profiler_saturate(stats->max);
+        uint16_t mean = cycle_profiler_saturate(cycle_profiler_get_mean(cycle_profiler_frame_probe));
+
+        data[1] = (uint8_t)(min & 0xFF);
+        data[2] = (uint8_t)(min >> 8);
+        data[3] = (uint8_t)(max & 0xFF);
+        data[4] = (uint8_t)(max >> 8);
+        data[5] = (uint8_t)(mean & 0xFF);
+        data[6] = (uint8_t)(mean >> 8);
+        data[7] = (uint8_t)(stats->count & 0xFF);
+    } else {
+        uint32_t count = stats->count;
+
+        for (uint32_t n = 0; n < CYCLE_PROFILER_BINS_PER_PAGE; n++) {
+            uint32_t bin    = (page - 1) * CYCLE_PROFILER_BINS_PER_PAGE + n;
+            uint8_t percent = 0;
+
+            if (bin < CYCLE_PROFILER_BIN_NUM && count != 0 && stats->hist[bin] != 0) {
+                percent = (uint8_t)(((uint64_t)stats->hist[bin] * 100U + count - 1) / count);
+            }
+            data[1 + n] = percent;
+        }
+    }
+
+    cycle_profiler_frame_page++;
+    if (cycle_profiler_frame_page >= CYCLE_PROFILER_PAGE_NUM) {
+        cycle_profiler_frame_page = 0;
+        cycle_profiler_frame_probe++;
+        if (cycle_profiler_frame_probe >= CYCLE_PROBE_NUM) {
+            cycle_profiler_frame_probe = 0;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,256 @@
+#include "fault_comp.h"
+#include "hrtim.h"
+#include "analog_signal.h"
+#include "fsbb_pwm.h"
+
+#if (FAULT_COMP_ENABLE)
+
+// 一个比较器保护通道
+typedef struct
+{
+    COMP_TypeDef *comp;    // 比较器
+    uint32_t comp_input;   // COMP_CSR的INPSEL/INMSEL
+    DAC_TypeDef *dac;      // 给出阈值的DAC
+    uint32_t dac_channel;  // DAC通道,1或2
+    uint32_t fault;        // HRTIM_FAULT_x
+    uint32_t fault_flag;   // HRTIM_ISR_FLTx,与IER/ICR中的位置相同
+    uint32_t timer_fault;  // HRTIM_FLTR_FLTxEN
+    uint32_t source;       // FAULT_COMP_TRIP_xxx
+    adc_signal_t signal;   // 被比较的模拟信号,用于阈值换算
+    float threshold;       // 实际值阈值
+} fault_comp_channel_t;
+
+// 比较器与HRTIM内部故障输入的固定连接:COMP1->FLT4, COMP5->FLT6
+static const fault_comp_channel_t fault_comp_channels[] = {
+    // COMP5 INP0 = PB13, INM = DAC4_CH1
+    {COMP5, COMP_CSR_INMSEL_2, DAC4, 1, HRTIM_FAULT_6, HRTIM_ISR_FLT6, HRTIM_FLTR_FLT6EN,
+     FAULT_COMP_TRIP_V_MOTOR, ADC_SIGNAL_V_MOTOR, MOTOR_VOLTAGE_TRIP},
+#if (FAULT_COMP_OCP_ENABLE)
+    // COMP1 INP1 = PB1, INM = DAC3_CH1
+    {COMP1, COMP_CSR_INPSEL | COMP_CSR_INMSEL_2, DAC3, 1, HRTIM_FAULT_4, HRTIM_ISR_FLT4, HRTIM_FLTR_FLT4EN,
+     FAULT_COMP_TRIP_I_CAP, ADC_SIGNAL_I_CAP, CAP_CURRENT_TRIP},
+#endif
+};
+
+#define FAULT_COMP_CHANNEL_NUM (sizeof(fault_comp_channels) / sizeof(fault_comp_channels[0]))
+
+// 所有通道的HRTIM故障标志
+static uint32_t fault_comp_flags = 0;
+#endif
+
+#define FAULT_COMP_DAC_TIMEOUT (2U) // DAC就绪超时,ms
+
+// 触发过的比较器保护
+static volatile uint32_t fault_comp_trip_source = 0;
+// 阈值超出传感器测量范围、被收紧到量程内的比较器保护
+static uint32_t fault_comp_derated = 0;
+
+#if (FAULT_COMP_ENABLE)
+// 通道阈值对应的DAC值。阈值先收紧到传感器测量范围内,超出量程的阈值比较器永远不会翻转
+static uint16_t fault_comp_threshold(const fault_comp_channel_t *ch)
+{
+    float threshold = get_adc_trip_limit(ch->signal, ch->threshold);
+    if (threshold != ch->threshold) {
+        fault_comp_derated |= ch->source;
+    }
+    return get_adc_raw_from_value(ch->signal, threshold);
+}
+#endif
+
+// 写DAC阈值,无触发时一个APB时钟后生效
+void BSP_COMP_DAC_Set(DAC_TypeDef *dac, uint32_t channel, uint16_t value)
+{
+    if (channel == 1) {
+        dac->DHR12R1 = value;
+    } else {
+        dac->DHR12R2 = value;
+    }
+}
+
+/**************************************************************************************
+ * @brief   比较器阈值DAC通道初始化,只连接片内比较器,不输出到引脚。
+ *          AHB时钟170MHz超过160MHz,需要选择对应的高频接口模式。
+ *
+ * @param   dac     DAC3或DAC4。
+ * @param   channel DAC通道,1或2。
+ * @param   value   初始12位阈值。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void BSP_COMP_DAC_Init(DAC_TypeDef *dac, uint32_t channel, uint16_t value)
+{
+    uint32_t shift = (channel == 1) ? 0U : 16U;
+
+    // MODE只能在通道关闭时修改
+    dac->CR &= ~(DAC_CR_EN1 << shift);
+    dac->MCR = (dac->MCR & ~((DAC_MCR_MODE1 << shift) | DAC_MCR_HFSEL)) |
+               ((DAC_MCR_MODE1_1 | DAC_MCR_MODE1_0) << shift) | DAC_MCR_HFSEL_1;
+    BSP_COMP_DAC_Set(dac, channel, value);
+    dac->CR |= DAC_CR_EN1 << shift;
+
+    uint32_t tickstart = HAL_GetTick();
+    while ((dac->SR & (DAC_SR_DAC1RDY << shift)) == 0) {
+        if ((HAL_GetTick() - tickstart) > FAULT_COMP_DAC_TIMEOUT) {
+            Error_Handler();
+        }
+    }
+}
+
+/**************************************************************************************
+ * @brief   配置DAC阈值、比较器和HRTIM故障输入,然后使能故障保护。
+ *          阈值按当前板子的校准数据换算,需要在BSP_ADC_Convert_Start之后、开启输出之前调用。
+ *          TA1/TA2/TD1/TD2的故障状态设为无效电平,只能在输出关闭时修改。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void BSP_FAULT_Init(void)
+{
+#if (FAULT_COMP_ENABLE)
+    HRTIM_FaultCfgTypeDef fault_cfg = {0};
+
+    __HAL_RCC_SYSCFG_CLK_ENABLE();
+    __HAL_RCC_DAC3_CLK_ENABLE();
+    __HAL_RCC_DAC4_CLK_ENABLE();
+
+#if (FAULT_COMP_OCP_ENABLE)
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+    GPIO_InitStruct.Pin  = GPIO_PIN_1;
+    GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+#endif
+
+    fault_cfg.Source   = HRTIM_FAULTSOURCE_INTERNAL;
+    fault_cfg.Polarity = HRTIM_FAULTPOLARITY_HIGH;
+    fault_cfg.Filter   = HRTIM_FAULTFILTER_3; // fHRTIM采样,连续8次,约47ns
+    fault_cfg.Lock     = HRTIM_FAULTLOCK_READWRITE;
+
+    fault_comp_flags = 0;
+    for (uint32_t n = 0; n < FAULT_COMP_CHANNEL_NUM; n++) {
+        const fault_comp_channel_t *ch = &fault_comp_channels[n];
+
+        BSP_COMP_DAC_Init(ch->dac, ch->dac_channel, fault_comp_threshold(ch));
+        ch->comp->CSR = ch->comp_input | COMP_CSR_HYST_1 | COMP_CSR_EN; // 20mV迟滞
+
+        if (HAL_HRTIM_FaultConfig(&hhrtim1, ch->fault, &fault_cfg) != HAL_OK) {
+            Error_Handler();
+        }
+        HAL_HRTIM_FaultModeCtl(&hhrtim1, ch->fault, HRTIM_FAULTMODECTL_ENABLED);
+        fault_comp_flags |= ch->fault_flag;
+    }
+
+    // 比较器启动时间最长5us
+    HAL_Delay(1);
+
+    HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].OUTxR =
+        (HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].OUTxR & ~(HRTIM_OUTR_FAULT1 | HRTIM_OUTR_FAULT2)) |
+        HRTIM_OUTR_FAULT1_1 | HRTIM_OUTR_FAULT2_1;
+    HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].OUTxR =
+        (HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].OUTxR & ~(HRTIM_OUTR_FAULT1 | HRTIM_OUTR_FAULT2)) |
+        HRTIM_OUTR_FAULT1_1 | HRTIM_OUTR_FAULT2_1;
+
+    // 与ADC模拟看门狗相同的最高优先级
+    HAL_NVIC_SetPriority(HRTIM1_FLT_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(HRTIM1_FLT_IRQn);
+
+    BSP_FAULT_Arm();
+#endif
+}
+
+// 重新写入阈值,清除故障标志,对Timer A/D使能故障输入和故障中断
+void BSP_FAULT_Arm(void)
+{
+#if (FAULT_COMP_ENABLE)
+    uint32_t timer_faults = 0;
+    for (uint32_t n = 0; n < FAULT_COMP_CHANNEL_NUM; n++) {
+        const fault_comp_channel_t *ch = &fault_comp_channels[n];
+        BSP_COMP_DAC_Set(ch->dac, ch->dac_channel, fault_comp_threshold(ch));
+        timer_faults |= ch->timer_fault;
+    }
+
+    HRTIM1->sCommonRegs.ICR = fault_comp_flags;
+    HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].FLTxR |= timer_faults;
+    HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].FLTxR |= timer_faults;
+    HRTIM1->sCommonRegs.IER |= fault_comp_flags;
+#endif
+}
+
+/**************************************************************************************
+ * @brief   清除HRTIM故障标志。比较器仍处于越限状态时不清除,
+ *          此时重新开启的输出会被HRTIM继续保持在故障状态。
+ *
+ * @return  HAL_OK - 已清除; HAL_BUSY - 仍有比较器越限。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+HAL_StatusTypeDef BSP_FAULT_Clear(void)
+{
+#if (FAULT_COMP_ENABLE)
+    if (get_fault_comp_active()) {
+        return HAL_BUSY;
+    }
+    HRTIM1->sCommonRegs.ICR = fault_comp_flags;
+#endif
+    return HAL_OK;
+}
+
+/**************************************************************************************
+ * @brief   比较器保护触发后的回调,在HRTIM故障中断中调用。
+ *          输出此时已经被硬件关闭,回调只负责锁存和上报。
+ *
+ * @param   source  越限的通道,FAULT_COMP_TRIP_xxx的组合。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+__weak void BSP_FAULT_Callback(uint32_t source)
+{
+    (void)source;
+}
+
+void BSP_FAULT_IRQHandler(void)
+{
+#if (FAULT_COMP_ENABLE)
+    uint32_t flags = HRTIM1->sCommonRegs.ISR & HRTIM1->sCommonRegs.IER & fault_comp_flags;
+    HRTIM1->sCommonRegs.ICR = flags;
+
+    uint32_t source = 0;
+    for (uint32_t n = 0; n < FAULT_COMP_CHANNEL_NUM; n++) {
+        if (flags & fault_comp_channels[n].fault_flag) {
+            source |= fault_comp_channels[n].source;
+        }
+    }
+
+    if (source) {
+        fault_comp_trip_source |= source;
+        BSP_FAULT_Callback(source);
+    }
+#endif
+}
+
+// 当前仍处于越限状态的比较器,FAULT_COMP_TRIP_xxx的组合
+uint32_t get_fault_comp_active()
+{
+    uint32_t source = 0;
+#if (FAULT_COMP_ENABLE)
+    for (uint32_t n = 0; n < FAULT_COMP_CHANNEL_NUM; n++) {
+        if (fault_comp_channels[n].comp->CSR & COMP_CSR_VALUE) {
+            source |= fault_comp_channels[n].source;
+        }
+    }
+#endif
+    return source;
+}
+
+// 复位以来触发过的比较器保护,FAULT_COMP_TRIP_xxx的组合
+uint32_t get_fault_comp_trip_source()
+{
+    return fault_comp_trip_source;
+}
+
+// 阈值超出传感器测量范围、实际在更低的值触发的比较器保护,FAULT_COMP_TRIP_xxx的组合
+uint32_t get_fault_comp_derated()
+{
+    return fault_comp_derated;
+}
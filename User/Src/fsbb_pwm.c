@@ -41,11 +41,15 @@
 #include "tim.h"
 #include "analog_signal.h"
 #include "incremental_pid.h"
+#include "compensator.h"
 #include "comm.h"
+#include "fault_comp.h"
+#include "cycle_profiler.h"
+#include "cpu_monitor.h"
 
 #define FSBB_GENERAL_TO_NARROW_RATIO  0.9f                   // 广义占空比到狭义占空比的比例
-#define FSBB_PERIOD_FULL              (27200U)               // 周期长度全位置
-#define FSBB_PERIOD_HALF              (FSBB_PERIOD_FULL / 2) // 周期长度半位置
+#define FSBB_HRTIM_FREQ               (170000000.0f * 32.0f) // HRTIM计数频率
+#define FSBB_PERIOD_FULL              (27200U)               // 标称周期长度,即hrtim.c中的配置
 #define FSBB_PERIOD_ZERO              (0U)                   // 周期长度零位置
 
 #define TARGET_POWER_MAX              (200.0f) // 补血区底盘功率上限为200W
@@ -53,10 +57,184 @@
 
 #define MAX_POWERLOSED_DETECTION_TIME (1145U) // 最大掉电检测时间
 
-incremental_pid_t pid_cap_voltage_h;
-incremental_pid_t pid_cap_voltage_l;
-incremental_pid_t pid_power;
-incremental_pid_t pid_current;
+#if (FSBB_BUCK_BOOST_MODULATION)
+    #define FSBB_MODULATION_HYST (0.01f) // 由buck/boost区进入过渡区的电压比迟滞,需要小于FSBB_BUCK_BOOST_BAND
+
+// 电压模式的调制区
+typedef enum
+{
+    FSBB_MODULATION_BUCK = 0,   // 底盘侧调制,电容侧广义常开
+    FSBB_MODULATION_BUCK_BOOST, // 两侧同时调制
+    FSBB_MODULATION_BOOST,      // 电容侧调制,底盘侧广义常开
+} fsbb_modulation_t;
+
+static fsbb_modulation_t fsbb_modulation = FSBB_MODULATION_BUCK;
+#endif
+
+#if (FSBB_SWITCHING_FREQ_MIN < 84000U) || (FSBB_SWITCHING_FREQ_MIN > FSBB_SWITCHING_FREQ_MAX)
+    #error "FSBB_SWITCHING_FREQ_MIN must be 84kHz ~ FSBB_SWITCHING_FREQ_MAX"
+#endif
+
+#if (FSBB_ADC_TRIGGER_DIV < 1) || (FSBB_ADC_TRIGGER_DIV > 32)
+    #error "FSBB_ADC_TRIGGER_DIV must be 1 ~ 32"
+#endif
+
+// ADC触发控制环时,序列转换必须在最短开关周期下的触发间隔内完成,否则触发被忽略,控制环降速
+#if (FSBB_LOOP_TRIGGER == FSBB_LOOP_TRIGGER_ADC) && \
+    (FSBB_ADC_TRIGGER_DIV * 1000000000ULL / FSBB_SWITCHING_FREQ_MAX <= ADC_SEQUENCE_TIME_NS)
+    #error "ADC sequence longer than FSBB_ADC_TRIGGER_DIV switching periods, enable ADC_FAST_SEQUENCE or raise FSBB_ADC_TRIGGER_DIV"
+#endif
+
+#if (FSBB_PWM_BURST_DMA)
+    #if (FSBB_LOOP_TRIGGER != FSBB_LOOP_TRIGGER_ADC)
+        #error "FSBB_PWM_BURST_DMA requires FSBB_LOOP_TRIGGER_ADC"
+    #endif
+
+// 突发DMA的比较值块,按BDMADR的写入顺序排列:Timer A的CMP1、CMP3,Timer D的CMP1、CMP3。
+// DMA不能访问CCM SRAM,放在普通SRAM
+typedef enum
+{
+    FSBB_BURST_TA_CMP1 = 0,
+    FSBB_BURST_TA_CMP3,
+    FSBB_BURST_TD_CMP1,
+    FSBB_BURST_TD_CMP3,
+    FSBB_BURST_NUM,
+} fsbb_burst_index_t;
+
+static volatile uint32_t fsbb_burst_block[FSBB_BURST_NUM];
+#endif
+
+#if (FSBB_CONTROL_MODE == FSBB_CONTROL_MODE_CURRENT)
+    #if (FAULT_COMP_OCP_ENABLE)
+        #error "COMP1/DAC3_CH1 is used by current mode control"
+    #endif
+
+    #if (FSBB_PWM_BURST_DMA)
+        #error "current mode control writes the compare registers directly"
+    #endif
+
+    #define FSBB_CURRENT_DIRECTION_HYST (0.2f)  // 峰值/谷值模式切换的电流迟滞,A
+    #define FSBB_CURRENT_REGION_HYST    (0.02f) // 底盘侧/电容侧开关切换的电压比迟滞
+
+    // 斜坡补偿:补偿斜率取非截断区间电感电流斜率的FSBB_CURRENT_SLOPE_RATIO倍,不小于0.5时任意占空比都不会次谐波振荡
+    #define FSBB_CURRENT_INDUCTANCE     (10e-6f)  // 功率电感,H
+    #define FSBB_CURRENT_SLOPE_RATIO    (0.6f)    // 补偿斜率 / 非截断区间的电感电流斜率
+    #define FSBB_CURRENT_SLOPE_STEP     (17U)     // 锯齿波的步进间隔,TIM7计数值,170MHz下100ns
+    #define FSBB_CURRENT_BLANKING       (200e-9f) // 前沿消隐时间,不含死区,s
+    #define FSBB_DAC_TRIGGER_TIM7       (2U)      // DAC触发选择:TIM7_TRGO
+    #define FSBB_DAC_TRIGGER_HRTIM_RST1 (9U)      // DAC触发选择:hrtim_dac_reset_trg1,Timer A计数器复位
+    // 电感电流斜率(A/s)换算为每个步进的12.4格式DAC增量,还要乘以每安培的原始值
+    #define FSBB_CURRENT_SLOPE_SCALE    (FSBB_CURRENT_SLOPE_RATIO / FSBB_CURRENT_INDUCTANCE * FSBB_CURRENT_SLOPE_STEP / 170000000.0f * 16.0f)
+#endif
+
+// 控制环的运行频率,Hz。ADC触发时为标称开关频率下的值
+#if (FSBB_LOOP_TRIGGER == FSBB_LOOP_TRIGGER_ADC)
+    #define FSBB_LOOP_FREQ (FSBB_HRTIM_FREQ / FSBB_PERIOD_FULL / (FSBB_ADC_TRIGGER_DIV * ADC_BLOCK_DEPTH))
+#else
+    #define FSBB_LOOP_FREQ (170000000.0f / (171.0f * 50.0f)) // TIM6
+#endif
+
+// 电流内环的PID参数
+#define FSBB_CURRENT_KP (0.001f)
+#define FSBB_CURRENT_KI (0.00035f)
+
+// 电流内环的占空比前馈
+#define FSBB_FEEDFORWARD ((FSBB_DUTY_FEEDFORWARD) && (FSBB_CONTROL_MODE == FSBB_CONTROL_MODE_VOLTAGE))
+
+#if (FSBB_FEEDFORWARD)
+    #define FSBB_FF_R_LOOP       (0.03f) // 电感直流电阻与两个导通开关管的电阻,Ω
+    #define FSBB_FF_DT_BAND      (0.5f)  // 死区补偿随电流方向切换的过渡带,A,覆盖电感纹波
+    #define FSBB_FF_RESIDUAL_MAX (0.3f)  // 内环残差的限幅
+    // 前馈的一阶低通系数,回路电阻很小,未滤波的采样噪声会直接变成电流噪声
+    #define FSBB_FF_FILTER       (1.0f / 64.0f)
+    #define FSBB_CURRENT_OUT_MIN (-FSBB_FF_RESIDUAL_MAX)
+    #define FSBB_CURRENT_OUT_MAX (FSBB_FF_RESIDUAL_MAX)
+
+// 一个死区时间对应的广义占空比,按HRTIM的死区配置和当前开关周期计算
+static float fsbb_ff_deadtime       = 0.0f;
+static float fsbb_ff_deadtime_ticks = 0.0f; // 死区时间,HRTIM计数值
+static float fsbb_ff_ratio          = 1.0f; // 滤波后的电压比
+#else
+    #define FSBB_CURRENT_OUT_MIN (FACTOR_MIN)
+    #define FSBB_CURRENT_OUT_MAX (FACTOR_MAX)
+#endif
+
+// 电流内环使用补偿器:PID以外的控制律,或者在FMAC上计算
+#define FSBB_CURRENT_USE_COMP ((FSBB_CURRENT_LAW != FSBB_CURRENT_LAW_PID) || (FSBB_CURRENT_COMP_FMAC))
+
+#if (FSBB_CURRENT_USE_COMP)
+    #if (FSBB_CONTROL_MODE == FSBB_CONTROL_MODE_CURRENT)
+        #error "FSBB_CURRENT_LAW/FSBB_CURRENT_COMP_FMAC only apply to voltage mode control"
+    #endif
+
+    // 补偿器参数:积分增益与PID相同,第一个零点在PID的Kp/Ki转折处,低频段与PID一致
+    #define FSBB_CURRENT_COMP_K        (FSBB_CURRENT_KI * FSBB_LOOP_FREQ)
+    #define FSBB_CURRENT_COMP_F_ZERO1  (FSBB_CURRENT_COMP_K / (2.0f * 3.14159265f * FSBB_CURRENT_KP))
+    #define FSBB_CURRENT_COMP_F_ZERO2  (3000.0f)
+    #define FSBB_CURRENT_COMP_F_POLE1  (FSBB_LOOP_FREQ / 4.0f) // 抑制开关纹波和采样噪声
+    #define FSBB_CURRENT_COMP_F_POLE2  (FSBB_LOOP_FREQ / 4.0f)
+    #define FSBB_CURRENT_COMP_IN_RANGE (CAP_CURRENT_MAX) // FMAC的误差满量程,A
+
+// 电流内环补偿器
+static CCMRAM_DATA compensator_t fsbb_current_comp;
+#endif
+
+// 增益调度只用于CPU计算的PID控制律
+#define FSBB_GAIN_SCHEDULE ((FSBB_CURRENT_GAIN_SCHEDULE) && !(FSBB_CURRENT_USE_COMP) && (FSBB_CONTROL_MODE == FSBB_CONTROL_MODE_VOLTAGE))
+
+// 开关周期的范围,取偶数使半周期为整数
+#define FSBB_PERIOD_MIN ((uint32_t)(FSBB_HRTIM_FREQ / FSBB_SWITCHING_FREQ_MAX) & ~1U)
+#define FSBB_PERIOD_MAX ((uint32_t)(FSBB_HRTIM_FREQ / FSBB_SWITCHING_FREQ_MIN) & ~1U)
+#define FSBB_CMP_MIN    (0x60U) // HRTIM时钟×32时比较值的最小值
+
+// 当前开关周期,HRTIM计数值。修改后在下一次写比较值时与比较值一起写入主定时器
+static uint32_t fsbb_period                 = FSBB_PERIOD_FULL;
+// 广义占空比为1时比较值相对中心的跨度,Q16定点数。最长周期下约为2^31,与Q16的占空比相乘不超过64位
+static uint32_t fsbb_duty_to_compare_q16    = (uint32_t)(FSBB_GENERAL_TO_NARROW_RATIO * (FSBB_PERIOD_FULL / 2) * 65536.0f);
+static volatile uint8_t fsbb_period_pending = 0;
+
+// 开关频率自适应只用于TIM6触发的控制环
+#define FSBB_FREQ_ADAPT ((FSBB_ADAPTIVE_FREQUENCY) && (FSBB_LOOP_TRIGGER == FSBB_LOOP_TRIGGER_TIM6))
+
+#if (FSBB_FREQ_ADAPT)
+    #define FSBB_FREQ_LEVELS (6U)             // 开关频率的档数,包括上下限
+    #define FSBB_FREQ_HYST   (0.75f)          // 换档迟滞,档
+    #define FSBB_FREQ_ATTACK (1.0f / 16.0f)   // 电流上升时的滤波系数,负载突增时尽快回到高频
+    #define FSBB_FREQ_DECAY  (1.0f / 1024.0f) // 电流下降时的滤波系数,约3Hz
+
+static float fsbb_freq_current  = FSBB_FREQ_CURRENT_HEAVY; // 滤波后的电容电流绝对值
+static uint32_t fsbb_freq_level = FSBB_FREQ_LEVELS - 1U;
+#endif
+
+#if (FSBB_BURST)
+    #define FSBB_BURST_PERIOD       (200U) // 突发周期,开关周期数,即1ms
+    #define FSBB_BURST_IDLE         (190U) // 每个突发周期内关断的开关周期数,其余约一个控制环周期开关,刷新自举电容
+    #define FSBB_BURST_ENTER_LOOPS  ((uint32_t)(0.1f * FSBB_LOOP_FREQ)) // 低于进入功率持续100ms后进入
+    #define FSBB_BURST_DIODE_MARGIN (0.5f) // 进入突发模式时电容电压需要低于底盘电压的裕量,V
+
+static uint8_t fsbb_burst_active     = 0;
+static uint32_t fsbb_burst_enter_cnt = 0;    // 给定功率连续低于进入阈值的控制环次数
+static float fsbb_burst_v_cap        = 0.0f; // 进入突发模式时的电容电压
+
+// 突发模式的统计,由TIM16中断读取
+static volatile uint32_t fsbb_burst_loops       = 0;    // 上次读取驻留率以来处于突发模式的控制环次数
+static volatile uint32_t fsbb_burst_loops_total = 0;    // 上次读取驻留率以来的控制环次数
+static volatile uint32_t fsbb_burst_entries     = 0;    // 上电以来进入突发模式的次数
+
+// 突发模式前后的实测净输入功率(底盘端功率 - 电容端功率 = 底盘负载 + 变换器损耗),
+// 进入前与进入后各取一个FSBB_BURST_ENTER_LOOPS长的窗口,窗口内底盘负载视为不变,两者之差就是节省的损耗
+static float fsbb_burst_energy_mark          = 0.0f; // 当前测量窗口起点的底盘端与电容端累计能量之差,J
+static float fsbb_burst_power_pending        = 0.0f; // 进入前窗口的净输入功率,等待进入后窗口结束一起发布,W
+static uint32_t fsbb_burst_measure_cnt       = 0;    // 进入后窗口已经过的控制环次数
+static volatile float fsbb_burst_power_base  = 0.0f; // 最近一次完整测量中进入前的净输入功率,W
+static volatile float fsbb_burst_power_saved = 0.0f; // 最近一次完整测量中进入后净输入功率的减少量,W
+#endif
+
+// 电流内环的增益表,fsbb_pwm_init中按平均模型填入默认值
+static CCMRAM_DATA fsbb_gain_t fsbb_current_gain[FSBB_REGION_NUM][FSBB_GAIN_TABLE_SIZE];
+
+// 四个环路的计算核连续存放,一次控制环计算只访问这一段CCM SRAM
+CCMRAM_DATA pid_kernel_t fsbb_pid[FSBB_PID_NUM];
 
 float voltage_cap;
 float voltage_motor;
@@ -70,10 +248,599 @@ float pid_power_output;
 
 float calculatedChassisPower = 0.0f;
 
+// 多速率调度
+static uint32_t fsbb_loop_tick = 0;    // 输出开启以来的控制环触发次数
+static float fsbb_current_ref  = 0.0f; // 外环给出的电容电流给定,在外环两次运行之间保持
+
 //
 float test_target_power = 15.0f;
+
+// 硬件保护锁存的故障
+static volatile uint8_t fsbb_fault_latched = 0;
+
+// Timer A的死区时间,周期计数值。死区时钟为HRTIM时钟的2^DTPRSC/8,开关周期为PER个HRTIM时钟/32
+static uint32_t fsbb_pwm_dead_time_ticks(void)
+{
+    uint32_t dtr = hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].DTxR;
+
+    return (((dtr & HRTIM_DTR_DTR) >> HRTIM_DTR_DTR_Pos) << ((dtr & HRTIM_DTR_DTPRSC) >> HRTIM_DTR_DTPRSC_Pos)) * 4U;
+}
+
+#if (FSBB_CONTROL_MODE == FSBB_CONTROL_MODE_CURRENT)
+// 电流模式下比较器事件截断的导通区间
+typedef enum
+{
+    FSBB_CURRENT_BUCK_PEAK = 0, // 底盘侧开关,正向电流,截断底盘侧上管导通
+    FSBB_CURRENT_BUCK_VALLEY,   // 底盘侧开关,反向电流,截断底盘侧下管导通
+    FSBB_CURRENT_BOOST_PEAK,    // 电容侧开关,正向电流,截断电容侧下管导通
+    FSBB_CURRENT_BOOST_VALLEY,  // 电容侧开关,反向电流,截断电容侧上管导通
+} fsbb_current_route_t;
+
+static fsbb_current_route_t fsbb_current_route = FSBB_CURRENT_BUCK_PEAK;
+// 电容电流每安培对应的12位原始值,开启输出时按当前板子的校准数据计算
+static float fsbb_current_counts_per_amp = 0.0f;
+
+/**************************************************************************************
+ * @brief   把EEV4(COMP1)接到正在开关的桥臂对应的输出边沿上,并设置比较器极性。
+ *          开关的桥臂在主定时器周期事件(计数器复位)开始被截断的导通区间,在EEV4或CMP1(最长导通时间)结束,
+ *          区间起点与斜坡补偿的复位、EEV4前沿消隐的起点对齐;不开关的桥臂保持电压模式的CMP1/CMP3。
+ *          TA1/TD1的置位/复位源寄存器带预装载,与比较值在同一个更新事件生效;
+ *          比较器极性立即生效,切换当周期可能少截断一次。
+ *
+ * @param   route   比较器事件截断的导通区间。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void fsbb_pwm_current_route(fsbb_current_route_t route)
+{
+    uint32_t ta_set = HRTIM_OUTPUTSET_TIMCMP1;
+    uint32_t ta_rst = HRTIM_OUTPUTRESET_TIMCMP3;
+    uint32_t td_set = HRTIM_OUTPUTSET_TIMCMP1;
+    uint32_t td_rst = HRTIM_OUTPUTRESET_TIMCMP3;
+
+    // TA1(MOTOR_L)/TD1(CAP_L)驱动下管,为高时下管导通,TA2/TD2为互补的上管
+    switch (route) {
+        case FSBB_CURRENT_BUCK_PEAK: // TA1为低的区间
+            ta_rst = HRTIM_OUTPUTRESET_MASTERPER;
+            ta_set = HRTIM_OUTPUTSET_EEV_4 | HRTIM_OUTPUTSET_TIMCMP1;
+            break;
+        case FSBB_CURRENT_BUCK_VALLEY: // TA1为高的区间
+            ta_set = HRTIM_OUTPUTSET_MASTERPER;
+            ta_rst = HRTIM_OUTPUTRESET_EEV_4 | HRTIM_OUTPUTRESET_TIMCMP1;
+            break;
+        case FSBB_CURRENT_BOOST_PEAK: // TD1为高的区间
+            td_set = HRTIM_OUTPUTSET_MASTERPER;
+            td_rst = HRTIM_OUTPUTRESET_EEV_4 | HRTIM_OUTPUTRESET_TIMCMP1;
+            break;
+        case FSBB_CURRENT_BOOST_VALLEY: // TD1为低的区间
+        default:
+            td_rst = HRTIM_OUTPUTRESET_MASTERPER;
+            td_set = HRTIM_OUTPUTSET_EEV_4 | HRTIM_OUTPUTSET_TIMCMP1;
+            break;
+    }
+
+    HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].SETx1R = ta_set;
+    HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].RSTx1R = ta_rst;
+    HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].SETx1R = td_set;
+    HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].RSTx1R = td_rst;
+
+    // 谷值模式下电流低于给定时比较器输出有效
+    if (route == FSBB_CURRENT_BUCK_VALLEY || route == FSBB_CURRENT_BOOST_VALLEY) {
+        COMP1->CSR |= COMP_CSR_POLARITY;
+    } else {
+        COMP1->CSR &= ~COMP_CSR_POLARITY;
+    }
+
+    fsbb_current_route = route;
+}
+
+/**************************************************************************************
+ * @brief   电流模式的比较器、斜坡补偿和前沿消隐。
+ *          COMP1(PB1 vs DAC3_CH1)作为HRTIM EEV4。DAC3_CH1工作在锯齿波模式:
+ *          Timer A计数器复位(主定时器周期,被截断区间的起点)时复位到电流给定,之后每个TIM7更新事件步进一次。
+ *          EEV4在Timer A/D中从计数器复位到CMP2之间被消隐,覆盖死区和开通时的电流尖峰;
+ *          消隐需要EEV4经过HRTIM同步,不能使用低延迟模式。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void fsbb_pwm_current_init(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct                    = {0};
+    HRTIM_EventCfgTypeDef pEventCfg                     = {0};
+    HRTIM_TimerCtlTypeDef pTimerCtl                     = {0};
+    HRTIM_TimerEventFilteringCfgTypeDef pEventFilterCfg = {0};
+
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+    __HAL_RCC_SYSCFG_CLK_ENABLE();
+    __HAL_RCC_DAC3_CLK_ENABLE();
+    __HAL_RCC_TIM7_CLK_ENABLE();
+
+    GPIO_InitStruct.Pin  = GPIO_PIN_1;
+    GPIO_InitStruct.Mode = GPIO_MODE_ANALOG;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+    // 锯齿波的步进时钟,更新事件作为TRGO
+    TIM7->PSC = 0;
+    TIM7->ARR = FSBB_CURRENT_SLOPE_STEP - 1U;
+    TIM7->CR2 = TIM_CR2_MMS_1;
+    TIM7->CR1 = TIM_CR1_CEN;
+
+    // 锯齿波模式和触发源只能在通道关闭时修改,在BSP_COMP_DAC_Init使能通道之前写入。
+    // 校准数据尚未解析,先把阈值放在满量程,不步进
+    DAC3->CR     = (DAC3->CR & ~(DAC_CR_WAVE1 | DAC_CR_TSEL1)) | DAC_CR_WAVE1_1 | DAC_CR_WAVE1_0 |
+                   (FSBB_DAC_TRIGGER_HRTIM_RST1 << DAC_CR_TSEL1_Pos) | DAC_CR_TEN1;
+    DAC3->STMODR = (DAC3->STMODR & ~(DAC_STMODR_STRSTTRIGSEL1 | DAC_STMODR_STINCTRIGSEL1)) |
+                   (FSBB_DAC_TRIGGER_HRTIM_RST1 << DAC_STMODR_STRSTTRIGSEL1_Pos) |
+                   (FSBB_DAC_TRIGGER_TIM7 << DAC_STMODR_STINCTRIGSEL1_Pos);
+    DAC3->STR1   = 4095U << DAC_STR1_STRSTDATA1_Pos;
+    BSP_COMP_DAC_Init(DAC3, 1, 4095);
+    COMP1->CSR = COMP_CSR_INPSEL | COMP_CSR_INMSEL_2 | COMP_CSR_HYST_1 | COMP_CSR_EN;
+
+    // Timer A在计数器复位时给出锯齿波的复位触发
+    pTimerCtl.DualChannelDacReset  = HRTIM_TIMER_DCDR_COUNTER;
+    pTimerCtl.DualChannelDacStep   = HRTIM_TIMER_DCDS_CMP2;
+    pTimerCtl.DualChannelDacEnable = HRTIM_TIMER_DCDE_ENABLED;
+    if (HAL_HRTIM_TimerDualChannelDacConfig(&hhrtim1, HRTIM_TIMERINDEX_TIMER_A, &pTimerCtl) != HAL_OK) {
+        Error_Handler();
+    }
+
+    // 消隐窗口:死区之后再加上消隐时间
+    uint32_t blanking = fsbb_pwm_dead_time_ticks() + (uint32_t)(FSBB_CURRENT_BLANKING * FSBB_HRTIM_FREQ);
+    hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].CMP2xR = blanking;
+    hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].CMP2xR = blanking;
+
+    pEventFilterCfg.Filter = HRTIM_TIMEEVFLT_BLANKINGCMP2;
+    pEventFilterCfg.Latch  = HRTIM_TIMEVENTLATCH_DISABLED;
+    if (HAL_HRTIM_TimerEventFilteringConfig(&hhrtim1, HRTIM_TIMERINDEX_TIMER_A, HRTIM_EVENT_4, &pEventFilterCfg) != HAL_OK) {
+        Error_Handler();
+    }
+    if (HAL_HRTIM_TimerEventFilteringConfig(&hhrtim1, HRTIM_TIMERINDEX_TIMER_D, HRTIM_EVENT_4, &pEventFilterCfg) != HAL_OK) {
+        Error_Handler();
+    }
+
+    // 电平触发:消隐结束时电流已经超过阈值,仍然立即截断
+    pEventCfg.Source      = HRTIM_EEV4SRC_COMP1_OUT;
+    pEventCfg.Polarity    = HRTIM_EVENTPOLARITY_HIGH;
+    pEventCfg.Sensitivity = HRTIM_EVENTSENSITIVITY_LEVEL;
+    pEventCfg.Filter      = HRTIM_EVENTFILTER_NONE;
+    pEventCfg.FastMode    = HRTIM_EVENTFASTMODE_DISABLE;
+    if (HAL_HRTIM_EventConfig(&hhrtim1, HRTIM_EVENT_4, &pEventCfg) != HAL_OK) {
+        Error_Handler();
+    }
+
+    fsbb_pwm_current_route(FSBB_CURRENT_BUCK_PEAK);
+}
+
+/**************************************************************************************
+ * @brief   写入锯齿波的复位值(电流给定)和斜坡补偿的步进。
+ *          补偿斜率跟随非截断区间的电感电流斜率:
+ *          底盘侧开关时电容侧上管常通,峰值模式下降段为-V_cap/L,谷值模式上升段为(V_motor - V_cap)/L;
+ *          电容侧开关时底盘侧上管常通,峰值模式下降段为(V_motor - V_cap)/L,谷值模式上升段为V_motor/L。
+ *          峰值模式阈值随时间下降,谷值模式上升。复位值在下一个周期起点生效。
+ *
+ * @param   route       比较器事件截断的导通区间。
+ * @param   current_ref 电容侧电流给定,A。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static CCMRAM_FUNC void fsbb_pwm_current_slope(fsbb_current_route_t route, float current_ref)
+{
+    float slope;
+    switch (route) {
+        case FSBB_CURRENT_BUCK_PEAK:
+            slope = -voltage_cap;
+            break;
+        case FSBB_CURRENT_BUCK_VALLEY:
+            slope = voltage_motor - voltage_cap;
+            break;
+        case FSBB_CURRENT_BOOST_PEAK:
+            slope = voltage_motor - voltage_cap;
+            break;
+        case FSBB_CURRENT_BOOST_VALLEY:
+        default:
+            slope = voltage_motor;
+            break;
+    }
+    // 峰值模式只取下降、谷值模式只取上升,过渡点附近电压测量噪声不会让补偿反向
+    uint8_t valley = (route == FSBB_CURRENT_BUCK_VALLEY || route == FSBB_CURRENT_BOOST_VALLEY);
+    slope          = valley ? ((slope > 0.0f) ? slope : 0.0f) : ((slope < 0.0f) ? slope : 0.0f);
+
+    // 原始值的变化方向还取决于校准的斜率符号
+    float step   = slope * FSBB_CURRENT_SLOPE_SCALE * fsbb_current_counts_per_amp;
+    uint32_t dir = (step > 0.0f) ? DAC_STR1_STDIR1 : 0U;
+    step         = (step < 0.0f) ? -step : step;
+    step         = (step > 65535.0f) ? 65535.0f : step;
+
+    DAC3->STR1 = ((uint32_t)get_adc_raw_from_value(ADC_SIGNAL_I_CAP, current_ref) << DAC_STR1_STRSTDATA1_Pos) | dir |
+                 ((uint32_t)step << DAC_STR1_STINCDATA1_Pos);
+}
+#endif
+
+// PID参数,放在控制环旁边,主机仿真与板上使用同一组参数
+void my_pid_init(void)
+{
+    // 积分增益按全速运行整定,外环降速后乘以分频比
+    pid_kernel_init(&fsbb_pid[FSBB_PID_CAP_VOLTAGE_H], 0.8f, 0.005f * FSBB_VOLTAGE_LOOP_DIV, 0, -CAP_CURRENT_MAX, CAP_CURRENT_MAX);
+    pid_kernel_init(&fsbb_pid[FSBB_PID_CAP_VOLTAGE_L], 0.8f, 0.005f * FSBB_VOLTAGE_LOOP_DIV, 0, -CAP_CURRENT_MAX, CAP_CURRENT_MAX);
+    pid_kernel_init(&fsbb_pid[FSBB_PID_POWER], 0.0003f, 0.0004f * FSBB_POWER_LOOP_DIV, 0, -CAP_CURRENT_MAX, CAP_CURRENT_MAX);
+    pid_kernel_init(&fsbb_pid[FSBB_PID_CURRENT], FSBB_CURRENT_KP, FSBB_CURRENT_KI, 0, FSBB_CURRENT_OUT_MIN, FSBB_CURRENT_OUT_MAX);
+
+#if (FSBB_CURRENT_LAW == FSBB_CURRENT_LAW_TYPE2)
+    compensator_init_type2(&fsbb_current_comp, FSBB_CURRENT_COMP_K, FSBB_CURRENT_COMP_F_ZERO1, FSBB_CURRENT_COMP_F_POLE1,
+                           FSBB_LOOP_FREQ, FSBB_CURRENT_OUT_MIN, FSBB_CURRENT_OUT_MAX);
+#elif (FSBB_CURRENT_LAW == FSBB_CURRENT_LAW_TYPE3)
+    compensator_init_type3(&fsbb_current_comp, FSBB_CURRENT_COMP_K, FSBB_CURRENT_COMP_F_ZERO1, FSBB_CURRENT_COMP_F_ZERO2,
+                           FSBB_CURRENT_COMP_F_POLE1, FSBB_CURRENT_COMP_F_POLE2, FSBB_LOOP_FREQ, FSBB_CURRENT_OUT_MIN,
+                           FSBB_CURRENT_OUT_MAX);
+#elif (FSBB_CURRENT_COMP_FMAC)
+    compensator_init_pid(&fsbb_current_comp, FSBB_CURRENT_KP, FSBB_CURRENT_KI, 0, FSBB_CURRENT_OUT_MIN, FSBB_CURRENT_OUT_MAX);
+#endif
+#if (FSBB_CURRENT_COMP_FMAC)
+    compensator_fmac_attach(&fsbb_current_comp, FSBB_CURRENT_COMP_IN_RANGE);
+#endif
+}
+
+/**************************************************************************************
+ * @brief   按开关周期平均模型填入电流内环增益表的默认值。
+ *          底盘侧开关时电感电压对电压比的增益为d_cap·V_motor,与电压比无关;
+ *          电容侧开关时为d_motor·V_motor/r,电容电流又是电感电流的1/r,总增益随r^2下降。
+ *          增益表按r^2补偿,使各点的环路增益与电压比为1时相同。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void fsbb_current_gain_default(void)
+{
+    for (uint32_t n = 0; n < FSBB_GAIN_TABLE_SIZE; n++) {
+        float ratio = 1.0f + (FACTOR_MAX - 1.0f) * n / (FSBB_GAIN_TABLE_SIZE - 1U);
+
+        fsbb_current_gain[FSBB_REGION_BUCK][n].kp  = FSBB_CURRENT_KP;
+        fsbb_current_gain[FSBB_REGION_BUCK][n].ki  = FSBB_CURRENT_KI;
+        fsbb_current_gain[FSBB_REGION_BOOST][n].kp = FSBB_CURRENT_KP * ratio * ratio;
+        fsbb_current_gain[FSBB_REGION_BOOST][n].ki = FSBB_CURRENT_KI * ratio * ratio;
+    }
+}
+
+/**************************************************************************************
+ * @brief   修改电流内环增益表中的一个点,下一次控制环生效。
+ *
+ * @param   region  工作区
+ * @param   index   表中的点,0对应工作区电压比的下限,FSBB_GAIN_TABLE_SIZE - 1对应上限
+ * @param   gain    增量式PID的比例、积分系数
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void fsbb_current_gain_set(fsbb_region_t region, uint32_t index, fsbb_gain_t gain)
+{
+    if ((region >= FSBB_REGION_NUM) || (index >= FSBB_GAIN_TABLE_SIZE)) {
+        return;
+    }
+
+    // 比例、积分系数成对修改,避免控制环读到一半新一半旧的值
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    fsbb_current_gain[region][index] = gain;
+    __set_PRIMASK(primask);
+}
+
+fsbb_gain_t fsbb_current_gain_get(fsbb_region_t region, uint32_t index)
+{
+    fsbb_gain_t gain = {0};
+
+    if ((region < FSBB_REGION_NUM) && (index < FSBB_GAIN_TABLE_SIZE)) {
+        gain = fsbb_current_gain[region][index];
+    }
+    return gain;
+}
+
+/**************************************************************************************
+ * @brief   设置开关频率,限制在FSBB_SWITCHING_FREQ_MIN ~ FSBB_SWITCHING_FREQ_MAX。
+ *          新的周期在下一次写比较值时与按新周期换算的比较值一起写入,在同一个更新事件生效。
+ *
+ * @param   frequency   开关频率,Hz
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void fsbb_pwm_set_frequency(float frequency)
+{
+    frequency = (frequency < FSBB_SWITCHING_FREQ_MIN)   ? FSBB_SWITCHING_FREQ_MIN
+                : (frequency > FSBB_SWITCHING_FREQ_MAX) ? FSBB_SWITCHING_FREQ_MAX
+                                                        : frequency;
+
+    uint32_t period = (uint32_t)(FSBB_HRTIM_FREQ / frequency) & ~1U;
+    if (period == fsbb_period) {
+        return;
+    }
+
+    // 周期与换算系数成对修改,避免控制环读到一半新一半旧的值
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    fsbb_period              = period;
+    fsbb_duty_to_compare_q16 = (uint32_t)(FSBB_GENERAL_TO_NARROW_RATIO * (float)(period / 2U) * 65536.0f);
+#if (FSBB_FEEDFORWARD)
+    fsbb_ff_deadtime = fsbb_ff_deadtime_ticks / (float)period / FSBB_GENERAL_TO_NARROW_RATIO;
+#endif
+    fsbb_period_pending = 1;
+    __set_PRIMASK(primask);
+}
+
+float fsbb_pwm_get_frequency(void)
+{
+    return FSBB_HRTIM_FREQ / (float)fsbb_period;
+}
+
+// 主定时器的周期和ADC触发3的比较值(半周期),预装载,与Timer A/D的比较值在同一个更新事件生效
+static inline void fsbb_pwm_period_write(void)
+{
+    hhrtim1.Instance->sMasterRegs.MPER   = fsbb_period;
+    hhrtim1.Instance->sMasterRegs.MCMP1R = fsbb_period / 2U;
+    fsbb_period_pending                  = 0;
+}
+
+/**************************************************************************************
+ * @brief   检查最短开关周期下的比较值换算,与fsbb_pwm_write_duty相同。
+ *          广义占空比为1时底盘侧CMP3 = 周期 - 跨度仍在CMP1之后,中间的关断区间容纳两个死区;
+ *          电容侧以半周期为中心的比较值不小于HRTIM的最小比较值。不满足时进入Error_Handler。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void fsbb_pwm_period_check(void)
+{
+    uint32_t half      = FSBB_PERIOD_MIN / 2U;
+    uint32_t span      = (uint32_t)(FSBB_GENERAL_TO_NARROW_RATIO * (float)half);
+    uint32_t dead_time = fsbb_pwm_dead_time_ticks();
+
+    if ((FSBB_PERIOD_MIN - span <= FSBB_PERIOD_ZERO + span + 2U * dead_time) || (half - span < FSBB_CMP_MIN)) {
+        Error_Handler();
+    }
+}
+
+/**************************************************************************************
+ * @brief   配置运行时可变的开关周期。
+ *          Timer A/D由主定时器周期复位,周期寄存器固定为最长周期,实际开关周期只由主定时器决定。
+ *          主定时器周期与Timer A/D的比较值都在主定时器更新事件装载,
+ *          周期改变时不会出现按新周期换算的比较值在旧周期中生效的情况。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void fsbb_pwm_period_init(void)
+{
+    fsbb_pwm_period_check();
+
+    hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].PERxR = FSBB_PERIOD_MAX;
+    hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].PERxR = FSBB_PERIOD_MAX;
+
+    fsbb_period = 0; // 强制按标称频率重新计算换算系数
+    fsbb_pwm_set_frequency(FSBB_SWITCHING_FREQ_MAX);
+    fsbb_pwm_period_write();
+}
+
+// 电流内环从电压比ratio重新开始:有前馈时电压比由前馈给出,残差从0开始
+static void fsbb_current_loop_seed(float ratio)
+{
+#if (FSBB_FEEDFORWARD)
+    fsbb_ff_ratio                     = ratio;
+    fsbb_pid[FSBB_PID_CURRENT].output = 0.0f;
+    #if (FSBB_CURRENT_USE_COMP)
+    compensator_reset(&fsbb_current_comp, 0.0f);
+    #endif
+#else
+    fsbb_pid[FSBB_PID_CURRENT].output = ratio;
+    #if (FSBB_CURRENT_USE_COMP)
+    compensator_reset(&fsbb_current_comp, ratio);
+    #endif
+#endif
+}
+
+#if (FSBB_BURST)
+/**************************************************************************************
+ * @brief   配置HRTIM突发模式控制器,不启动。
+ *          突发时钟为主定时器周期(一个开关周期),连续模式,一次软件触发后一直运行到固件退出。
+ *          空闲期间Timer A/D的4路输出为无效电平,四个开关管全部关断,计数器时钟保持运行,
+ *          ADC触发和比较值更新不受影响。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void fsbb_burst_init(void)
+{
+    HRTIM_Common_TypeDef *common = &hhrtim1.Instance->sCommonRegs;
+
+    MODIFY_REG(hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].OUTxR,
+               HRTIM_OUTR_IDLM1 | HRTIM_OUTR_IDLES1 | HRTIM_OUTR_IDLM2 | HRTIM_OUTR_IDLES2, HRTIM_OUTR_IDLM1 | HRTIM_OUTR_IDLM2);
+    MODIFY_REG(hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].OUTxR,
+               HRTIM_OUTR_IDLM1 | HRTIM_OUTR_IDLES1 | HRTIM_OUTR_IDLM2 | HRTIM_OUTR_IDLES2, HRTIM_OUTR_IDLM1 | HRTIM_OUTR_IDLM2);
+
+    // 计数值从0开始
+    common->BMPER  = FSBB_BURST_PERIOD - 1U;
+    common->BMCMPR = FSBB_BURST_IDLE - 1U;
+    MODIFY_REG(common->BMCR, HRTIM_BMCR_BME | HRTIM_BMCR_BMCLK | HRTIM_BMCR_BMPRSC | HRTIM_BMCR_BMOM, HRTIM_BMCR_BMOM);
+}
+
+static CCMRAM_FUNC void fsbb_burst_enter(void)
+{
+    fsbb_burst_active = 1;
+    fsbb_burst_v_cap  = voltage_cap;
+    fsbb_burst_entries++;
+
+    hhrtim1.Instance->sCommonRegs.BMCR |= HRTIM_BMCR_BME;
+    hhrtim1.Instance->sCommonRegs.BMTRGR = HRTIM_BMTRGR_SW;
+}
+
+/**************************************************************************************
+ * @brief   立即退出突发模式,不等待突发周期结束。
+ *          关断期间电感电流已经回到0,内环按当前电压比重新开始,与开启输出时相同。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static CCMRAM_FUNC void fsbb_burst_exit(void)
+{
+    if (!fsbb_burst_active) {
+        return;
+    }
+
+    // BMSTAT写0立即结束当前突发,之后再关闭突发模式控制器
+    hhrtim1.Instance->sCommonRegs.BMCR &= ~HRTIM_BMCR_BMSTAT;
+    hhrtim1.Instance->sCommonRegs.BMCR &= ~HRTIM_BMCR_BME;
+
+    fsbb_burst_active    = 0;
+    fsbb_burst_enter_cnt = 0;
+    fsbb_current_loop_seed((voltage_motor > 1.0f) ? voltage_cap / voltage_motor : FACTOR_MAX);
+}
+#endif
+
+uint8_t fsbb_burst_get_state(void)
+{
+#if (FSBB_BURST)
+    return fsbb_burst_active;
+#else
+    return 0;
+#endif
+}
+
+/**************************************************************************************
+ * @brief   最近一次进入突发模式时实测的净输入功率和节省的功率,两者成对读取。
+ *          没有完成过测量(进入后100ms内就退出)时保持上一次的结果。
+ *
+ * @param   base    进入前的净输入功率(底盘负载 + 变换器损耗),W
+ * @param   saved   进入后净输入功率的减少量,W
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void fsbb_burst_get_power(float *base, float *saved)
+{
+#if (FSBB_BURST)
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *base  = fsbb_burst_power_base;
+    *saved = fsbb_burst_power_saved;
+    __set_PRIMASK(primask);
+#else
+    *base  = 0.0f;
+    *saved = 0.0f;
+#endif
+}
+
+// 上次调用以来处于突发模式的时间比例,‰
+uint16_t fsbb_burst_get_residency(void)
+{
+#if (FSBB_BURST)
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t loops         = fsbb_burst_loops;
+    uint32_t loops_total   = fsbb_burst_loops_total;
+    fsbb_burst_loops       = 0;
+    fsbb_burst_loops_total = 0;
+    __set_PRIMASK(primask);
+
+    return (loops_total == 0) ? 0 : (uint16_t)((uint64_t)loops * 1000U / loops_total);
+#else
+    return 0;
+#endif
+}
+
+uint32_t fsbb_burst_get_entries(void)
+{
+#if (FSBB_BURST)
+    return fsbb_burst_entries;
+#else
+    return 0;
+#endif
+}
+
+#if (FSBB_PWM_BURST_DMA)
+/**************************************************************************************
+ * @brief   配置HRTIM突发DMA更新Timer A/D的比较值。
+ *          主定时器重复事件产生DMA请求,DMA1_CH4把比较值块循环写入BDMADR,
+ *          突发DMA控制器按BDTxUPR的顺序分发到Timer A/D的CMP1/CMP3预装载寄存器。
+ *          Timer A/D改为突发DMA完成后立即更新,不再由主定时器更新和复位更新触发。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void fsbb_pwm_burst_init(void)
+{
+    HRTIM_Common_TypeDef *common = &hhrtim1.Instance->sCommonRegs;
+
+    // 块内先放入当前生效的比较值,第一次DMA不会改变输出
+    fsbb_burst_block[FSBB_BURST_TA_CMP1] = hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].CMP1xR;
+    fsbb_burst_block[FSBB_BURST_TA_CMP3] = hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].CMP3xR;
+    fsbb_burst_block[FSBB_BURST_TD_CMP1] = hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].CMP1xR;
+    fsbb_burst_block[FSBB_BURST_TD_CMP3] = hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].CMP3xR;
+
+    common->BDMUPR  = 0;
+    common->BDTAUPR = HRTIM_BDTUPR_TIMCMP1 | HRTIM_BDTUPR_TIMCMP3;
+    common->BDTBUPR = 0;
+    common->BDTCUPR = 0;
+    common->BDTDUPR = HRTIM_BDTUPR_TIMCMP1 | HRTIM_BDTUPR_TIMCMP3;
+    common->BDTEUPR = 0;
+    common->BDTFUPR = 0;
+
+    // 存储器到外设,32位,循环模式,每次请求写完整个块
+    DMA1_Channel4->CCR   = 0;
+    DMA1_Channel4->CPAR  = (uint32_t)&common->BDMADR;
+    DMA1_Channel4->CMAR  = (uint32_t)fsbb_burst_block;
+    DMA1_Channel4->CNDTR = FSBB_BURST_NUM;
+    DMA1_Channel4->CCR   = DMA_CCR_DIR | DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_PSIZE_1 | DMA_CCR_MSIZE_1 | DMA_CCR_PL_1;
+    // DMAMUX通道编号从0开始,DMA1_CH4对应DMAMUX1_Channel3
+    DMAMUX1_Channel3->CCR = DMA_REQUEST_HRTIM1_M;
+    DMA1_Channel4->CCR |= DMA_CCR_EN;
+
+    // 更新门控0001:突发DMA完成后更新。重复事件即主周期起点,比较值在同一个开关周期的起始处生效
+    for (uint32_t i = 0; i < 2; i++) {
+        uint32_t index = (i == 0) ? HRTIM_TIMERINDEX_TIMER_A : HRTIM_TIMERINDEX_TIMER_D;
+        MODIFY_REG(hhrtim1.Instance->sTimerxRegs[index].TIMxCR, HRTIM_TIMCR_UPDGAT | HRTIM_TIMCR_MSTU | HRTIM_TIMCR_TRSTU,
+                   HRTIM_TIMCR_UPDGAT_0);
+    }
+
+    hhrtim1.Instance->sMasterRegs.MDIER |= HRTIM_MDIER_MREPDE;
+}
+#endif
+
 void fsbb_pwm_init(void)
 {
+    fsbb_current_gain_default();
+#if (FSBB_CONTROL_MODE == FSBB_CONTROL_MODE_CURRENT)
+    fsbb_pwm_current_init();
+#endif
+#if (FSBB_FEEDFORWARD)
+    fsbb_ff_deadtime_ticks = (float)fsbb_pwm_dead_time_ticks();
+#endif
+    // Timer A不在复位时更新,Timer A/D都只在主定时器更新事件装载比较值,
+    // fsbb_pwm_set_duty写入的一组比较值在同一个开关周期同时生效
+    hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].TIMxCR &= ~HRTIM_TIMCR_TRSTU;
+#if (FSBB_LOOP_TRIGGER == FSBB_LOOP_TRIGGER_TIM6)
+    // 控制环与开关周期不同步,主定时器每个开关周期都更新,比较值在下一个开关周期生效。
+    // 主定时器重复中断没有使用,关闭以免每个开关周期进一次中断
+    hhrtim1.Instance->sMasterRegs.MREP = 0;
+    hhrtim1.Instance->sMasterRegs.MDIER &= ~HRTIM_MDIER_MREPIE;
+#endif
+    fsbb_pwm_period_init();
+    // ADC触发的后分频
+    MODIFY_REG(hhrtim1.Instance->sCommonRegs.ADCPS1, HRTIM_ADCPS1_AD1PSC | HRTIM_ADCPS1_AD3PSC,
+               ((FSBB_ADC_TRIGGER_DIV - 1) << HRTIM_ADCPS1_AD1PSC_Pos) | ((FSBB_ADC_TRIGGER_DIV - 1) << HRTIM_ADCPS1_AD3PSC_Pos));
+#if (FSBB_LOOP_TRIGGER == FSBB_LOOP_TRIGGER_ADC)
+    // 主定时器的更新事件(比较值预装载)与控制环同频同相:
+    // ADC触发每(ADxPSC+1)个主周期一次,控制环每ADC_BLOCK_DEPTH次触发运行一次,
+    // 重复计数器设为相同的分频,使每次控制环计算的比较值都在固定的开关周期位置生效
+    uint32_t adc_trigger_div = (hhrtim1.Instance->sCommonRegs.ADCPS1 & HRTIM_ADCPS1_AD1PSC) >> HRTIM_ADCPS1_AD1PSC_Pos;
+    uint32_t loop_div        = (adc_trigger_div + 1) * ADC_BLOCK_DEPTH - 1;
+    if (loop_div > HRTIM_MREP_MREP) {
+        Error_Handler();
+    }
+    hhrtim1.Instance->sMasterRegs.MREP = loop_div;
+#endif
+#if (FSBB_PWM_BURST_DMA)
+    fsbb_pwm_burst_init();
+#endif
+#if (FSBB_BURST)
+    fsbb_burst_init();
+#endif
     HAL_HRTIM_WaveformCounterStart(&hhrtim1, HRTIM_TIMERID_MASTER);
     HAL_HRTIM_WaveformCounterStart(&hhrtim1, HRTIM_TIMERID_TIMER_A);
     HAL_HRTIM_WaveformCounterStart(&hhrtim1, HRTIM_TIMERID_TIMER_D);
@@ -88,15 +855,34 @@ void fsbb_pwm_output_start(void)
 
 void fsbb_pwm_output_restart(void)
 {
+    // 硬件保护触发后锁存,直到上位机关闭输出才允许重新开启
+    if (fsbb_fault_latched) {
+        return;
+    }
+
     // 重新开启hrtim的时候要设置软启动
     float voltage_cap   = get_voltage_cap();
     float voltage_motor = get_voltage_motor();
 
+#if (FSBB_FREQ_ADAPT)
+    // 从标称频率开始,随滤波后的电流逐渐降低
+    fsbb_freq_current = FSBB_FREQ_CURRENT_HEAVY;
+    fsbb_freq_level   = FSBB_FREQ_LEVELS - 1U;
+    fsbb_pwm_set_frequency(FSBB_SWITCHING_FREQ_MAX);
+#endif
+
     if (voltage_motor >= 20.0f && voltage_motor <= 28.0f) {
         fsbb_pwm_set_factor(voltage_cap / voltage_motor);
-        pid_current.output = voltage_cap / voltage_motor;
+        fsbb_current_loop_seed(voltage_cap / voltage_motor);
     }
 
+#if (FSBB_CONTROL_MODE == FSBB_CONTROL_MODE_CURRENT)
+    // 此时校准数据已经解析,按±CAP_CURRENT_MAX两点换算,取整误差可以忽略
+    fsbb_current_counts_per_amp = ((float)get_adc_raw_from_value(ADC_SIGNAL_I_CAP, CAP_CURRENT_MAX) -
+                                   (float)get_adc_raw_from_value(ADC_SIGNAL_I_CAP, -CAP_CURRENT_MAX)) /
+                                  (2.0f * CAP_CURRENT_MAX);
+#endif
+
     HAL_HRTIM_WaveformOutputStart(&hhrtim1, HRTIM_OUTPUT_TA1 | HRTIM_OUTPUT_TA2 | HRTIM_OUTPUT_TD1 | HRTIM_OUTPUT_TD2);
 }
 
@@ -116,14 +902,57 @@ void fsbb_pwm_output_stop(void)
     // 调用HAL库函数来停止指定的HRTIM PWM输出通道。
     // 这里关闭的是TA1, TA2, TD1 和 TD2通道的PWM输出。
     HAL_HRTIM_WaveformOutputStop(&hhrtim1, HRTIM_OUTPUT_TA1 | HRTIM_OUTPUT_TA2 | HRTIM_OUTPUT_TD1 | HRTIM_OUTPUT_TD2);
+#if (FSBB_BURST)
+    fsbb_burst_exit();
+#endif
 
     // 注意：可以关闭PWM输出，但切勿在未关闭输出的情况下停止计数器(counter)，
     // 否则可能会导致不可预期的行为或错误。
 }
 
-void fsbb_pwm_set_cap(float general_duty)
+/**************************************************************************************
+ * @brief   硬件保护触发,立即关闭HRTIM输出并锁存故障。
+ *          直接写ODISR寄存器关闭TA1, TA2, TD1 和 TD2,不经过HAL,可以在任意中断中调用。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC void fsbb_pwm_fault_trip(void)
+{
+    HRTIM1->sCommonRegs.ODISR = HRTIM_ODISR_TA1ODIS | HRTIM_ODISR_TA2ODIS | HRTIM_ODISR_TD1ODIS | HRTIM_ODISR_TD2ODIS;
+    fsbb_fault_latched        = 1;
+}
+
+// 清除锁存的故障,之后fsbb_pwm_output_restart()才能重新开启输出
+// 比较器仍处于越限状态时保持锁存
+void fsbb_pwm_fault_clear(void)
+{
+    if (BSP_FAULT_Clear() != HAL_OK) {
+        return;
+    }
+    fsbb_fault_latched = 0;
+}
+
+uint8_t fsbb_pwm_fault_get(void)
+{
+    return fsbb_fault_latched;
+}
+
+// ADC模拟看门狗越限,在ADC中断中直接关闭输出
+CCMRAM_FUNC void BSP_ADC_WatchdogCallback(uint32_t source)
+{
+    fsbb_pwm_fault_trip();
+}
+
+// 比较器越限,输出已由HRTIM故障输入关闭,锁存故障以阻止重新开启
+CCMRAM_FUNC void BSP_FAULT_Callback(uint32_t source)
+{
+    fsbb_pwm_fault_trip();
+}
+
+// 广义占空比对应的比较值跨度:狭义占空比 × 半周期
+static inline uint32_t fsbb_pwm_duty_span(float general_duty, float general_duty_min)
 {
-    const float general_duty_min = 0.5f; // 广义占空比最低值
     const float general_duty_max = 1.0f; // 广义占空比占空比最高值
 
     // 使用条件运算符限制数值
@@ -131,40 +960,94 @@ void fsbb_pwm_set_cap(float general_duty)
                    : (general_duty > general_duty_max) ? general_duty_max
                                                        : general_duty;
 
-    // 在电容端移相了 180°
-    // 低侧管低电平持续时间就是高侧管高电平持续时间
-    int32_t LowSide_LowLevel_Start_Comp1 = FSBB_PERIOD_HALF + general_duty * FSBB_GENERAL_TO_NARROW_RATIO * FSBB_PERIOD_HALF;
+    // 乘以2^16换算为Q16可由一条带小数位的VCVT完成,之后是32×32→64位的整数乘法
+    uint32_t duty_q16 = (uint32_t)(general_duty * 65536.0f);
+    return (uint32_t)(((uint64_t)duty_q16 * fsbb_duty_to_compare_q16) >> 32);
+}
 
-    int32_t LowSide_LowLevel_End_Comp3 = FSBB_PERIOD_HALF - general_duty * FSBB_GENERAL_TO_NARROW_RATIO * FSBB_PERIOD_HALF;
+/**************************************************************************************
+ * @brief   由两个桥臂的广义占空比计算并写入Timer A/D的4个比较值。
+ *          每个桥臂的占空比换算为Q16后与Q16的换算系数做一次64位整数乘法得到比较值跨度,之后都是整数运算。
+ *          开关周期改变后,第一次调用时同时写入主定时器的周期。
+ *          调用方需要保证写入期间Timer A/D的更新已被禁止,见fsbb_pwm_set_duty。
+ *          FSBB_PWM_BURST_DMA时只写入突发DMA的比较值块。
+ *
+ * @param   motor_duty  底盘侧广义占空比,0.15 ~ 1
+ * @param   cap_duty    电容侧广义占空比,0.5 ~ 1
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static CCMRAM_FUNC void fsbb_pwm_write_duty(float motor_duty, float cap_duty)
+{
+    uint32_t period     = fsbb_period;
+    uint32_t half       = period / 2U;
+    uint32_t motor_span = fsbb_pwm_duty_span(motor_duty, 0.15f);
+    uint32_t cap_span   = fsbb_pwm_duty_span(cap_duty, 0.5f);
 
-    // 低侧管低电平 and 高侧管高电平 开始
-    __HAL_HRTIM_SETCOMPARE(&hhrtim1, HRTIM_TIMERINDEX_TIMER_D, HRTIM_COMPAREUNIT_1, LowSide_LowLevel_Start_Comp1);
-    // 低侧管低电平 and 高侧管高电平 结束
-    __HAL_HRTIM_SETCOMPARE(&hhrtim1, HRTIM_TIMERINDEX_TIMER_D, HRTIM_COMPAREUNIT_3, LowSide_LowLevel_End_Comp3);
+    if (fsbb_period_pending) {
+        fsbb_pwm_period_write();
+    }
+
+#if (FSBB_PWM_BURST_DMA)
+    // 只写比较值块,由下一次重复事件的突发DMA写入寄存器
+    fsbb_burst_block[FSBB_BURST_TA_CMP1] = FSBB_PERIOD_ZERO + motor_span;
+    fsbb_burst_block[FSBB_BURST_TA_CMP3] = period - motor_span;
+    fsbb_burst_block[FSBB_BURST_TD_CMP1] = half + cap_span;
+    fsbb_burst_block[FSBB_BURST_TD_CMP3] = half - cap_span;
+#else
+    // 低侧管低电平持续时间就是高侧管高电平持续时间,底盘侧以周期起点为中心
+    hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].CMP1xR = FSBB_PERIOD_ZERO + motor_span;
+    hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].CMP3xR = period - motor_span;
+    // 在电容端移相了 180°,以半周期为中心
+    hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].CMP1xR = half + cap_span;
+    hhrtim1.Instance->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].CMP3xR = half - cap_span;
+#endif
 }
 
-void fsbb_pwm_set_motor(float general_duty)
+// 禁止/恢复主定时器和Timer A/D的预装载传输。禁止期间到来的更新事件不传输,恢复后下一个更新事件一次性生效
+static inline void fsbb_pwm_update_disable(void)
 {
-    const float general_duty_min = 0.15f; // 广义占空比最低值
-    const float general_duty_max = 1.0f;  // 广义占空比占空比最高值
+    hhrtim1.Instance->sCommonRegs.CR1 |= HRTIM_CR1_MUDIS | HRTIM_CR1_TAUDIS | HRTIM_CR1_TDUDIS;
+}
 
-    // 使用条件运算符限制数值
-    general_duty = (general_duty < general_duty_min)   ? general_duty_min
-                   : (general_duty > general_duty_max) ? general_duty_max
-                                                       : general_duty;
+static inline void fsbb_pwm_update_enable(void)
+{
+    hhrtim1.Instance->sCommonRegs.CR1 &= ~(HRTIM_CR1_MUDIS | HRTIM_CR1_TAUDIS | HRTIM_CR1_TDUDIS);
+}
 
-    // 低侧管低电平持续时间就是高侧管高电平持续时间
-    int32_t LowSide_LowLevel_Start_Comp1 = FSBB_PERIOD_ZERO + general_duty * FSBB_GENERAL_TO_NARROW_RATIO * FSBB_PERIOD_HALF;
+/**************************************************************************************
+ * @brief   同时设置两个桥臂的广义占空比。
+ *          4个比较值在禁止更新期间写入,在同一个更新事件生效,不会出现一个周期只更新了一半的情况。
+ *
+ * @param   motor_duty  底盘侧广义占空比
+ * @param   cap_duty    电容侧广义占空比
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC void fsbb_pwm_set_duty(float motor_duty, float cap_duty)
+{
+#if (FSBB_PWM_BURST_DMA)
+    // 突发DMA一次写完4个比较值后才更新,不需要禁止更新
+    fsbb_pwm_write_duty(motor_duty, cap_duty);
+#else
+    fsbb_pwm_update_disable();
+    fsbb_pwm_write_duty(motor_duty, cap_duty);
+    fsbb_pwm_update_enable();
+#endif
+}
 
-    int32_t LowSide_LowLevel_End_Comp3 = FSBB_PERIOD_FULL - general_duty * FSBB_GENERAL_TO_NARROW_RATIO * FSBB_PERIOD_HALF;
+#if (FSBB_BUCK_BOOST_MODULATION)
+// 过渡区的电容侧广义占空比:从1线性降到1/band_high,两端分别与buck区、boost区重合
+static inline float fsbb_band_cap_duty(float scaling_factor)
+{
+    const float band_low  = 1.0f - FSBB_BUCK_BOOST_BAND;
+    const float band_high = 1.0f + FSBB_BUCK_BOOST_BAND;
 
-    // 低侧管低电平 and 高侧管高电平 开始
-    __HAL_HRTIM_SETCOMPARE(&hhrtim1, HRTIM_TIMERINDEX_TIMER_A, HRTIM_COMPAREUNIT_1, LowSide_LowLevel_Start_Comp1);
-    // 低侧管低电平 and 高侧管高电平 结束
-    __HAL_HRTIM_SETCOMPARE(&hhrtim1, HRTIM_TIMERINDEX_TIMER_A, HRTIM_COMPAREUNIT_3, LowSide_LowLevel_End_Comp3);
+    return 1.0f + (scaling_factor - band_low) * (1.0f / band_high - 1.0f) / (band_high - band_low);
 }
+#endif
 
-void fsbb_pwm_set_factor(float scaling_factor)
+CCMRAM_FUNC void fsbb_pwm_set_factor(float scaling_factor)
 {
     const float factor_range_min = FACTOR_MIN; // 允许的倍数的最小值
     const float factor_range_max = FACTOR_MAX; // 允许的倍数的最大值
@@ -174,14 +1057,97 @@ void fsbb_pwm_set_factor(float scaling_factor)
                      : (scaling_factor > factor_range_max) ? factor_range_max
                                                            : scaling_factor;
 
+#if (FSBB_BUCK_BOOST_MODULATION)
+    const float band_low  = 1.0f - FSBB_BUCK_BOOST_BAND;
+    const float band_high = 1.0f + FSBB_BUCK_BOOST_BAND;
+
+    // 从过渡区退出的位置与buck/boost区的占空比完全一致,进入过渡区需要越过迟滞
+    switch (fsbb_modulation) {
+        case FSBB_MODULATION_BUCK:
+            if (scaling_factor > band_low + FSBB_MODULATION_HYST) {
+                fsbb_modulation = (scaling_factor > band_high) ? FSBB_MODULATION_BOOST : FSBB_MODULATION_BUCK_BOOST;
+            }
+            break;
+        case FSBB_MODULATION_BOOST:
+            if (scaling_factor < band_high - FSBB_MODULATION_HYST) {
+                fsbb_modulation = (scaling_factor < band_low) ? FSBB_MODULATION_BUCK : FSBB_MODULATION_BUCK_BOOST;
+            }
+            break;
+        default:
+            if (scaling_factor < band_low) {
+                fsbb_modulation = FSBB_MODULATION_BUCK;
+            } else if (scaling_factor > band_high) {
+                fsbb_modulation = FSBB_MODULATION_BOOST;
+            }
+            break;
+    }
+
+    if (fsbb_modulation == FSBB_MODULATION_BUCK_BOOST) {
+        // 底盘侧 = 电压比 × 电容侧。电感电压对电压比的增益为d_cap·V_motor,在两端同样与buck区、boost区相等
+        float cap_duty = fsbb_band_cap_duty(scaling_factor);
+        fsbb_pwm_set_duty(scaling_factor * cap_duty, cap_duty);
+        return;
+    }
+
+    if (fsbb_modulation == FSBB_MODULATION_BUCK) {
+#else
     if (scaling_factor <= 1.0f) {
-        fsbb_pwm_set_motor(scaling_factor); // 设置电机占空比
-        fsbb_pwm_set_cap(1.0f);             // 设置电容为广义常开
+#endif
+        fsbb_pwm_set_duty(scaling_factor, 1.0f); // 设置电机占空比,电容为广义常开
     } else {
-        fsbb_pwm_set_motor(1.0f);                // 设置电机为广义常开
-        fsbb_pwm_set_cap(1.0f / scaling_factor); // 设置电容占空比
+        fsbb_pwm_set_duty(1.0f, 1.0f / scaling_factor); // 设置电机为广义常开,电容占空比
+    }
+}
+
+#if (FSBB_CONTROL_MODE == FSBB_CONTROL_MODE_CURRENT)
+/**************************************************************************************
+ * @brief   电流模式内环:把电流给定写入比较器阈值,比较值只作为最大导通时间。
+ *          电压比 <= 1时底盘侧桥臂开关,> 1时电容侧桥臂开关;
+ *          给定为正时截断使电流上升的导通区间(峰值),为负时截断使电流下降的导通区间(谷值)。
+ *          阈值带斜坡补偿,被截断区间的占空比超过50%时也不会出现次谐波振荡。
+ *
+ * @param   current_ref     电容侧电流给定,A。
+ * @param   scaling_factor  电容电压 / 底盘电压。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC void fsbb_pwm_set_current(float current_ref, float scaling_factor)
+{
+    current_ref = (current_ref < -CAP_CURRENT_MAX)  ? -CAP_CURRENT_MAX
+                  : (current_ref > CAP_CURRENT_MAX) ? CAP_CURRENT_MAX
+                                                    : current_ref;
+
+    // 区间与方向都带迟滞,避免在边界处来回切换置位/复位源
+    uint8_t boost  = (fsbb_current_route == FSBB_CURRENT_BOOST_PEAK || fsbb_current_route == FSBB_CURRENT_BOOST_VALLEY);
+    uint8_t valley = (fsbb_current_route == FSBB_CURRENT_BUCK_VALLEY || fsbb_current_route == FSBB_CURRENT_BOOST_VALLEY);
+    if (scaling_factor > 1.0f + FSBB_CURRENT_REGION_HYST) {
+        boost = 1;
+    } else if (scaling_factor < 1.0f - FSBB_CURRENT_REGION_HYST) {
+        boost = 0;
+    }
+    if (current_ref < -FSBB_CURRENT_DIRECTION_HYST) {
+        valley = 1;
+    } else if (current_ref > FSBB_CURRENT_DIRECTION_HYST) {
+        valley = 0;
     }
+
+    fsbb_current_route_t route = boost ? (valley ? FSBB_CURRENT_BOOST_VALLEY : FSBB_CURRENT_BOOST_PEAK)
+                                       : (valley ? FSBB_CURRENT_BUCK_VALLEY : FSBB_CURRENT_BUCK_PEAK);
+    fsbb_pwm_current_slope(route, current_ref);
+
+    // 置位/复位源与比较值在同一个更新事件生效
+    fsbb_pwm_update_disable();
+    if (route != fsbb_current_route) {
+        fsbb_pwm_current_route(route);
+    }
+
+    // 另一侧桥臂广义常开;开关的桥臂CMP1为从周期起点计的最长导通时间,与广义常开的狭义占空比相同
+    fsbb_pwm_write_duty(1.0f, 1.0f);
+    uint32_t timer = boost ? HRTIM_TIMERINDEX_TIMER_D : HRTIM_TIMERINDEX_TIMER_A;
+    hhrtim1.Instance->sTimerxRegs[timer].CMP1xR = (uint32_t)(FSBB_GENERAL_TO_NARROW_RATIO * (float)fsbb_period);
+    fsbb_pwm_update_enable();
 }
+#endif
 
 //
 static uint16_t powerlosed_cnt = 0; // 掉电计数器
@@ -204,97 +1170,411 @@ void powerlosed_detection(void)
         //
     }
 }
-void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+
+#if (FSBB_GAIN_SCHEDULE)
+// 在一个工作区的增益表中按电压比查表,相邻两点间线性插值
+static CCMRAM_FUNC fsbb_gain_t fsbb_current_gain_lookup(fsbb_region_t region, float ratio)
 {
-    if (htim->Instance == TIM16) {
-        // 2ms定时器用于发送can消息
-        can_send();
+    float position = (region == FSBB_REGION_BUCK) ? (ratio - FACTOR_MIN) / (1.0f - FACTOR_MIN)
+                                                  : (ratio - 1.0f) / (FACTOR_MAX - 1.0f);
+    position       = (position < 0.0f) ? 0.0f : (position > 1.0f) ? 1.0f : position;
+    position *= (float)(FSBB_GAIN_TABLE_SIZE - 1U);
 
-        // 2ms定时器用于计数CAN断联时间
-        can_recevie_cnt_add();
+    uint32_t index = (uint32_t)position;
+    if (index > FSBB_GAIN_TABLE_SIZE - 2U) {
+        index = FSBB_GAIN_TABLE_SIZE - 2U;
+    }
+    float fraction = position - (float)index;
 
-        // chassis&cap负向电流时，认为下电
-        powerlosed_detection();
+    const fsbb_gain_t *table = &fsbb_current_gain[region][index];
+    fsbb_gain_t gain;
+    gain.kp = table[0].kp + fraction * (table[1].kp - table[0].kp);
+    gain.ki = table[0].ki + fraction * (table[1].ki - table[0].ki);
+    return gain;
+}
 
-        HAL_GPIO_TogglePin(USR_LED_GPIO_Port, USR_LED_Pin);
-    } else if (htim->Instance == TIM6) {
-        // adc线性映射
-        voltage_cap   = get_voltage_cap();
-        voltage_motor = get_voltage_motor();
+/**************************************************************************************
+ * @brief   按当前的调制区查增益表,更新电流内环的增益。
+ *          升降压过渡区两个桥臂同时开关,增益在buck表的band_low点与boost表的band_high点之间
+ *          按电压比线性插值,与两侧的调制区连续。
+ *
+ * @param   ratio   上一次控制环输出的电压比
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static CCMRAM_FUNC void fsbb_current_gain_schedule(float ratio)
+{
+    fsbb_gain_t gain;
 
-        current_cap     = get_current_cap();
-        current_chassis = get_current_chassis();
+#if (FSBB_BUCK_BOOST_MODULATION)
+    if (fsbb_modulation == FSBB_MODULATION_BUCK_BOOST) {
+        const float band_low  = 1.0f - FSBB_BUCK_BOOST_BAND;
+        const float band_high = 1.0f + FSBB_BUCK_BOOST_BAND;
 
-        // test
+        fsbb_gain_t low  = fsbb_current_gain_lookup(FSBB_REGION_BUCK, band_low);
+        fsbb_gain_t high = fsbb_current_gain_lookup(FSBB_REGION_BOOST, band_high);
+        float fraction   = (ratio - band_low) / (band_high - band_low);
+        fraction         = (fraction < 0.0f) ? 0.0f : (fraction > 1.0f) ? 1.0f : fraction;
+        gain.kp          = low.kp + fraction * (high.kp - low.kp);
+        gain.ki          = low.ki + fraction * (high.ki - low.ki);
+    } else {
+        gain = fsbb_current_gain_lookup((fsbb_modulation == FSBB_MODULATION_BUCK) ? FSBB_REGION_BUCK : FSBB_REGION_BOOST, ratio);
+    }
+#else
+    gain = fsbb_current_gain_lookup((ratio <= 1.0f) ? FSBB_REGION_BUCK : FSBB_REGION_BOOST, ratio);
+#endif
+    pid_kernel_set_gains(&fsbb_pid[FSBB_PID_CURRENT], gain.kp, gain.ki, 0.0f);
+}
+#endif
 
-        DcdcOutputState dcdc_output_state = UpdateDcdcOutputState(can_rx_data.enabled);
+#if (FSBB_FEEDFORWARD)
+/**************************************************************************************
+ * @brief   由本次测得的电压、电流计算电流内环的前馈电压比。
+ *          理想电压比为(电容电压 + 回路电阻压降) / 底盘电压,经一阶低通滤除采样噪声(约50Hz)。
+ *          死区期间电流经体二极管续流:电流为正(向电容充电)时底盘侧桥臂的有效占空比少一个死区,
+ *          电容侧桥臂多一个死区,电流为负时相反。按当前的调制区反解出需要给定的电压比,
+ *          升降压过渡区两个桥臂同时开关,两侧的死区都计入。
+ *          电流方向在过渡带内线性过渡,避免零电流附近来回跳变。
+ *
+ * @return  float   前馈电压比
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static CCMRAM_FUNC float fsbb_duty_feedforward(void)
+{
+    if (voltage_motor <= 1.0f) {
+        return FACTOR_MAX;
+    }
 
-        // DcdcOutputState dcdc_output_state = DCDC_OUTPUT_OUTPUT_ENABLED;
+    float ratio = (voltage_cap + FSBB_FF_R_LOOP * current_cap) / voltage_motor;
+    fsbb_ff_ratio += FSBB_FF_FILTER * (ratio - fsbb_ff_ratio);
 
-        //
+    float direction = current_cap / FSBB_FF_DT_BAND;
+    direction       = (direction > 1.0f) ? 1.0f : (direction < -1.0f) ? -1.0f : direction;
 
-        // 如果CAN断联超时了
-        if (CAN_DISCONNECT_MAX_COUNT <= can_recevie_cnt_get()) {
-            can_rx_data.enabled = 0;
-            dcdc_output_state   = DCDC_OUTPUT_OUTPUT_DISABLED;
-        }
+    ratio           = fsbb_ff_ratio;
+    float dead_time = fsbb_ff_deadtime * direction * (1.0f + ratio);
+#if (FSBB_BUCK_BOOST_MODULATION)
+    if (fsbb_modulation == FSBB_MODULATION_BUCK_BOOST) {
+        // (d_motor - D) / (d_cap + D) = ratio的一阶解,两端分别与buck区、boost区的解连续
+        return ratio + dead_time / fsbb_band_cap_duty(ratio); // 两侧同时开关
+    }
+    if (fsbb_modulation == FSBB_MODULATION_BUCK) {
+#else
+    if (ratio <= 1.0f) {
+#endif
+        return ratio + dead_time; // 底盘侧开关
+    } else {
+        return ratio / (1.0f - dead_time); // 电容侧开关
+    }
+}
+#endif
 
-        // 更新dcdc输出状态
-        if (DCDC_OUTPUT_OUTPUT_DISABLED == dcdc_output_state) {
-            fsbb_pwm_output_stop();
-            HAL_GPIO_WritePin(USR_LED_GPIO_Port, USR_LED_Pin, GPIO_PIN_SET);
-            can_rx_data.targetChassisPower = DEFAULT_TARGET_POWER;
-        } else if (DCDC_OUTPUT_TRANSITION_TO_DISABLED == dcdc_output_state) {
-            fsbb_pwm_output_stop();
-        } else if (DCDC_OUTPUT_TRANSITION_TO_ENABLED == dcdc_output_state) {
-
-            my_pid_init();
-            fsbb_pwm_output_restart();
+#if (FSBB_BURST)
+// 底盘端与电容端累计能量之差,J,对时间的增量就是净输入功率
+static inline float fsbb_burst_net_energy(void)
+{
+    return get_energy_chassis() - get_energy_cap();
+}
+
+/**************************************************************************************
+ * @brief   突发模式的进入/退出判断与统计,每次控制环调用一次。
+ *          进入只看外环给定,给定连续100ms低于进入功率且电容电压低于底盘电压时进入;
+ *          退出同时看给定和实测电流,覆盖负载突变和关断期间意外出现的电流。
+ *          进入前的100ms等待窗口与进入后的第一个100ms窗口分别由累计能量测出净输入功率。
+ *
+ * @return  uint8_t 1 - 处于突发模式,本次不运行电流内环
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static CCMRAM_FUNC uint8_t fsbb_burst_update(void)
+{
+    float current_ref = (fsbb_current_ref < 0.0f) ? -fsbb_current_ref : fsbb_current_ref;
+
+    const float window = (float)FSBB_BURST_ENTER_LOOPS / FSBB_LOOP_FREQ; // 测量窗口,s
+
+    if (!fsbb_burst_active) {
+        if ((current_ref * voltage_cap < FSBB_BURST_POWER_ENTER) && (voltage_cap + FSBB_BURST_DIODE_MARGIN < voltage_motor)) {
+            if (fsbb_burst_enter_cnt == 0) {
+                fsbb_burst_energy_mark = fsbb_burst_net_energy();
+            }
+            if (++fsbb_burst_enter_cnt >= FSBB_BURST_ENTER_LOOPS) {
+                float energy             = fsbb_burst_net_energy();
+                fsbb_burst_power_pending = (energy - fsbb_burst_energy_mark) / window;
+                fsbb_burst_energy_mark   = energy;
+                fsbb_burst_measure_cnt   = 0;
+                fsbb_burst_enter();
+            }
+        } else {
+            fsbb_burst_enter_cnt = 0;
         }
+    } else {
+        float current = (current_cap < 0.0f) ? -current_cap : current_cap;
+        current       = (current > current_ref) ? current : current_ref;
+        float ripple  = voltage_cap - fsbb_burst_v_cap;
+        ripple        = (ripple < 0.0f) ? -ripple : ripple;
+        if ((current * voltage_cap > FSBB_BURST_POWER_EXIT) || (ripple > FSBB_BURST_RIPPLE)) {
+            fsbb_burst_exit();
+        } else if ((fsbb_burst_measure_cnt < FSBB_BURST_ENTER_LOOPS) && (++fsbb_burst_measure_cnt == FSBB_BURST_ENTER_LOOPS)) {
+            float power            = (fsbb_burst_net_energy() - fsbb_burst_energy_mark) / window;
+            fsbb_burst_power_base  = fsbb_burst_power_pending;
+            fsbb_burst_power_saved = fsbb_burst_power_pending - power;
+        }
+    }
 
-        if (DCDC_OUTPUT_OUTPUT_ENABLED == dcdc_output_state) {
-            HAL_GPIO_WritePin(USR_LED_GPIO_Port, USR_LED_Pin, GPIO_PIN_RESET);
-            // 计算chassis端的功率值
-            calculatedChassisPower = voltage_motor * current_chassis;
+    fsbb_burst_loops_total++;
+    if (fsbb_burst_active) {
+        fsbb_burst_loops++;
+    }
+    return fsbb_burst_active;
+}
 
-            // error检查
-            // 暂无
+// 突发模式下的电压比:保持理想电压比,保留的开关段几乎不产生电流
+static CCMRAM_FUNC float fsbb_burst_ratio(void)
+{
+    #if (FSBB_FEEDFORWARD)
+    return fsbb_duty_feedforward();
+    #else
+    return (voltage_motor > 1.0f) ? voltage_cap / voltage_motor : FACTOR_MAX;
+    #endif
+}
+#endif
 
-            // pid环路计算
+#if (FSBB_FREQ_ADAPT)
+/**************************************************************************************
+ * @brief   按电容电流选择开关频率。
+ *          电流绝对值经非对称低通滤波:上升快,负载突增时在几个控制环周期内回到高频;下降慢,
+ *          避免负载波动时频繁换档。滤波值在轻载/重载阈值之间线性映射到FSBB_FREQ_LEVELS个等间距的频率档,
+ *          越过当前档位FSBB_FREQ_HYST档以上才换档。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static CCMRAM_FUNC void fsbb_frequency_adapt(void)
+{
+    float current = (current_cap < 0.0f) ? -current_cap : current_cap;
+    float filter  = (current > fsbb_freq_current) ? FSBB_FREQ_ATTACK : FSBB_FREQ_DECAY;
+    fsbb_freq_current += filter * (current - fsbb_freq_current);
 
-            // test
-            pid_power.setValue = (float)can_rx_data.targetChassisPower;
+    float position = (fsbb_freq_current - FSBB_FREQ_CURRENT_LIGHT) / (FSBB_FREQ_CURRENT_HEAVY - FSBB_FREQ_CURRENT_LIGHT);
+    position       = (position < 0.0f) ? 0.0f : (position > 1.0f) ? 1.0f : position;
+    position *= (float)(FSBB_FREQ_LEVELS - 1U);
 
-            // pid_power.setValue = test_target_power;
+    float level = (float)fsbb_freq_level;
+    if ((position > level + FSBB_FREQ_HYST) || (position < level - FSBB_FREQ_HYST)) {
+        const float step = (float)(FSBB_SWITCHING_FREQ_MAX - FSBB_SWITCHING_FREQ_MIN) / (float)(FSBB_FREQ_LEVELS - 1U);
 
-            if (pid_power.setValue >= TARGET_POWER_MAX) {
-                pid_power.setValue = TARGET_POWER_MAX;
-            } else if (pid_power.setValue <= TARGET_POWER_MIN) {
-                pid_power.setValue = TARGET_POWER_MIN;
-            }
+        fsbb_freq_level = (uint32_t)(position + 0.5f);
+        fsbb_pwm_set_frequency((float)FSBB_SWITCHING_FREQ_MIN + (float)fsbb_freq_level * step);
+    }
+}
+#endif
 
-            pid_cap_voltage_h_output = incremental_pid_compute(&pid_cap_voltage_h, voltage_cap);
-            pid_cap_voltage_l_output = incremental_pid_compute(&pid_cap_voltage_l, voltage_cap);
-            pid_power_output         = incremental_pid_compute(&pid_power, calculatedChassisPower);
-
-            float current_ref = pid_power_output;
-            if (current_ref > pid_cap_voltage_h_output) {
-                pid_power.output = pid_cap_voltage_h_output;
-                current_ref      = pid_cap_voltage_h_output;
-            } else if (current_ref < pid_cap_voltage_l_output) {
-                pid_power.output = pid_cap_voltage_l_output;
-                current_ref      = pid_cap_voltage_l_output;
-            } else {
-                pid_cap_voltage_h.output = current_ref;
-                pid_cap_voltage_l.output = current_ref;
-            }
+#if (FSBB_CONTROL_MODE == FSBB_CONTROL_MODE_VOLTAGE)
+/**************************************************************************************
+ * @brief   电压模式的电容电流内环,由电流误差计算电压比。
+ *
+ * @return  float   电压比,即广义占空比
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static CCMRAM_FUNC float fsbb_current_loop(void)
+{
+    float ratio;
+
+    #if (FSBB_CURRENT_USE_COMP)
+    ratio = compensator_compute(&fsbb_current_comp, fsbb_current_ref - current_cap);
+    #else
+        #if (FSBB_GAIN_SCHEDULE)
+    fsbb_current_gain_schedule(general_duty);
+        #endif
+    ratio = pid_kernel_compute(&fsbb_pid[FSBB_PID_CURRENT], fsbb_current_ref - current_cap);
+    #endif
+    #if (FSBB_FEEDFORWARD)
+    ratio += fsbb_duty_feedforward();
+    #endif
+    return ratio;
+}
+#endif
 
-            pid_current.setValue = current_ref;
-            general_duty         = incremental_pid_compute(&pid_current, current_cap);
-            // pwm输出
-            fsbb_pwm_set_factor(general_duty);
+/**************************************************************************************
+ * @brief   级联控制的外环,按多速率调度降速运行,更新电容电流给定fsbb_current_ref。
+ *          电压上下限环在第0拍一起计算,功率环在第1拍计算,
+ *          功率环输出被最近一次的电压环输出限幅,被限幅的一侧做积分跟踪。
+ *
+ * @param   tick    输出开启以来的控制环触发次数。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static CCMRAM_FUNC void fsbb_cascade_outer(uint32_t tick)
+{
+    if (tick % FSBB_VOLTAGE_LOOP_DIV == 0) {
+        const float error[2] = {CAP_VOLTAGE_MAX - voltage_cap, CAP_VOLTAGE_MIN - voltage_cap};
+        float output[2];
+
+        pid_kernel_compute_batch(&fsbb_pid[FSBB_PID_CAP_VOLTAGE_H], error, output, 2);
+        pid_cap_voltage_h_output = output[0];
+        pid_cap_voltage_l_output = output[1];
+    }
+
+    if (tick % FSBB_POWER_LOOP_DIV == 1 % FSBB_POWER_LOOP_DIV) {
+        // 计算chassis端的功率值
+        calculatedChassisPower = get_power_chassis();
+
+        float target_power = (float)can_rx_data.targetChassisPower;
+        if (target_power >= TARGET_POWER_MAX) {
+            target_power = TARGET_POWER_MAX;
+        } else if (target_power <= TARGET_POWER_MIN) {
+            target_power = TARGET_POWER_MIN;
+        }
+
+        pid_power_output = pid_kernel_compute(&fsbb_pid[FSBB_PID_POWER], target_power - calculatedChassisPower);
+
+        float current_ref = pid_power_output;
+        if (current_ref > pid_cap_voltage_h_output) {
+            fsbb_pid[FSBB_PID_POWER].output = pid_cap_voltage_h_output;
+            current_ref                     = pid_cap_voltage_h_output;
+        } else if (current_ref < pid_cap_voltage_l_output) {
+            fsbb_pid[FSBB_PID_POWER].output = pid_cap_voltage_l_output;
+            current_ref                     = pid_cap_voltage_l_output;
         } else {
-            // Do nothing
+            fsbb_pid[FSBB_PID_CAP_VOLTAGE_H].output = current_ref;
+            fsbb_pid[FSBB_PID_CAP_VOLTAGE_L].output = current_ref;
+        }
+        fsbb_current_ref = current_ref;
+    }
+}
+
+/**************************************************************************************
+ * @brief   功率控制环,执行一次完整的PID级联计算并更新PWM比较值。
+ *          根据FSBB_LOOP_TRIGGER由TIM6中断或ADC1序列转换完成中断调用。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC void fsbb_control_loop(void)
+{
+    CYCLE_PROFILER_BEGIN();
+
+    // adc线性映射
+    voltage_cap   = get_voltage_cap();
+    voltage_motor = get_voltage_motor();
+
+    current_cap     = get_current_cap();
+    current_chassis = get_current_chassis();
+
+    // test
+
+    DcdcOutputState dcdc_output_state = UpdateDcdcOutputState(can_rx_data.enabled);
+
+    // DcdcOutputState dcdc_output_state = DCDC_OUTPUT_OUTPUT_ENABLED;
+
+    //
+
+    // 如果CAN断联超时了
+    if (CAN_DISCONNECT_MAX_COUNT <= can_recevie_cnt_get()) {
+        can_rx_data.enabled = 0;
+        dcdc_output_state   = DCDC_OUTPUT_OUTPUT_DISABLED;
+    }
+
+    // 更新dcdc输出状态
+    if (DCDC_OUTPUT_OUTPUT_DISABLED == dcdc_output_state) {
+        fsbb_pwm_output_stop();
+        fsbb_pwm_fault_clear();
+        HAL_GPIO_WritePin(USR_LED_GPIO_Port, USR_LED_Pin, GPIO_PIN_SET);
+        can_rx_data.targetChassisPower = DEFAULT_TARGET_POWER;
+    } else if (DCDC_OUTPUT_TRANSITION_TO_DISABLED == dcdc_output_state) {
+        fsbb_pwm_output_stop();
+    } else if (DCDC_OUTPUT_TRANSITION_TO_ENABLED == dcdc_output_state) {
+
+        my_pid_init();
+        fsbb_loop_tick   = 0;
+        fsbb_current_ref = 0.0f;
+        // 累计能量从开启输出时重新开始
+        reset_energy();
+        fsbb_pwm_output_restart();
+    }
+
+    if (DCDC_OUTPUT_OUTPUT_ENABLED == dcdc_output_state) {
+        HAL_GPIO_WritePin(USR_LED_GPIO_Port, USR_LED_Pin, GPIO_PIN_RESET);
+
+        // error检查
+        // 暂无
+
+        // 外环按多速率调度降速运行,内环每次触发都运行
+        fsbb_cascade_outer(fsbb_loop_tick++);
+
+#if (FSBB_FREQ_ADAPT)
+        // 新的开关周期与本次计算的比较值一起写入
+        fsbb_frequency_adapt();
+#endif
+
+#if (FSBB_CONTROL_MODE == FSBB_CONTROL_MODE_CURRENT)
+        // 内环由比较器逐周期完成
+        fsbb_pwm_set_current(fsbb_current_ref, (voltage_motor > 1.0f) ? voltage_cap / voltage_motor : FACTOR_MAX);
+#else
+    #if (FSBB_BURST)
+        // 突发模式下电流内环暂停
+        general_duty = fsbb_burst_update() ? fsbb_burst_ratio() : fsbb_current_loop();
+    #else
+        general_duty = fsbb_current_loop();
+    #endif
+        // pwm输出
+        fsbb_pwm_set_factor(general_duty);
+#endif
+    } else {
+        // Do nothing
+    }
+
+    CYCLE_PROFILER_END(CYCLE_PROBE_CONTROL_LOOP);
+}
+
+// 由flash中的HAL_TIM_IRQHandler分发,TIM16的CAN/LED路径不是热路径,只有fsbb_control_loop放在CCM SRAM
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    if (htim->Instance == TIM16) {
+        // 2ms定时器用于发送can消息
+        can_send();
+        can_send_load();
+#if (FSBB_BURST)
+        can_send_burst();
+#endif
+        can_send_energy();
+#if (CYCLE_PROFILER_ENABLE)
+        can_send_profile();
+#endif
+
+        // 2ms定时器用于计数CAN断联时间
+        can_recevie_cnt_add();
+
+        // chassis&cap负向电流时，认为下电
+        powerlosed_detection();
+
+        HAL_GPIO_TogglePin(USR_LED_GPIO_Port, USR_LED_Pin);
+    }
+#if (FSBB_LOOP_TRIGGER == FSBB_LOOP_TRIGGER_TIM6)
+    else if (htim->Instance == TIM6) {
+        // 进入回调时的计数值就是触发后经过的时间,超过半个周期说明被其他中断推迟
+        uint8_t late = (__HAL_TIM_GET_COUNTER(htim) > __HAL_TIM_GET_AUTORELOAD(htim) / 2U);
+
+        fsbb_control_loop();
+
+        // HAL在调用回调前已清除更新标志,结束时再次置位说明下一次触发已经到来
+        if (late || __HAL_TIM_GET_FLAG(htim, TIM_FLAG_UPDATE)) {
+            cpu_monitor_overrun();
         }
     }
+#endif
+}
+
+#if (FSBB_LOOP_TRIGGER == FSBB_LOOP_TRIGGER_ADC)
+// ADC1在主定时器周期处采样,序列结束后立即计算,新的比较值在下一次主定时器更新事件生效
+CCMRAM_FUNC void BSP_ADC_SequenceCpltCallback(void)
+{
+    fsbb_control_loop();
+
+    if (BSP_ADC_SequencePending()) {
+        cpu_monitor_overrun();
+    }
 }
+#endif
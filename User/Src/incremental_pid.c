@@ -1,4 +1,5 @@
 #include "incremental_pid.h"
+#include "main.h"
 #include <stdio.h>
 #include <string.h> // For memset
 
@@ -20,11 +21,10 @@ void incremental_pid_init(incremental_pid_t* pid, float kp, float ki, float kd,
 {
     memset(pid, 0, sizeof(incremental_pid_t)); // 将结构体pid的所有成员初始化为0
 
-    pid->Kp             = kp;         // 设置比例系数
-    pid->Ki             = ki;         // 设置积分系数
-    pid->Kd             = kd;         // 设置微分系数
-    pid->outputMinLimit = min_output; // 设置输出下限
-    pid->outputMaxLimit = max_output; // 设置输出上限
+    pid->Kp = kp; // 设置比例系数
+    pid->Ki = ki; // 设置积分系数
+    pid->Kd = kd; // 设置微分系数
+    pid_kernel_init(&pid->kernel, kp, ki, kd, min_output, max_output);
 }
 
 /**************************************************************************************
@@ -39,45 +39,17 @@ void incremental_pid_init(incremental_pid_t* pid, float kp, float ki, float kd,
  * @date    2025 - 01 - 11
  * @copyright Copyright (C) 2025 Hong HongLin.  All Rights Reserved.
  *************************************************************************************/
-float incremental_pid_compute(incremental_pid_t* pid, float newActualValue)
+CCMRAM_FUNC float incremental_pid_compute(incremental_pid_t* pid, float newActualValue)
 {
     // 更新PID控制器中的实际值为最新的测量值
     pid->actualValue = newActualValue;
 
-    // 初始化增量变量
-    float increment;
-
     // 计算当前误差（设定值与实际值之差）
     pid->error = pid->setValue - pid->actualValue;
 
-    // 计算比例项：当前误差的变化量乘以比例系数Kp
-    pid->P = pid->Kp * (pid->error - pid->errorPre);
-
-    // 计算积分项：当前误差乘以积分系数Ki
-    pid->I = pid->Ki * pid->error;
-
-    // 计算微分项：误差变化率乘以微分系数Kd
-    pid->D = pid->Kd * (pid->error - 2 * pid->errorPre + pid->errorPrePre);
-
-    // 根据比例、积分和微分项计算总的增量
-    increment = pid->P + pid->I + pid->D;
-
-    // 更新输出值并添加增量
-    pid->output += increment;
-
-    // 对输出值进行限幅处理，确保不超过最大或最小限制
-    if (pid->output > pid->outputMaxLimit)
-    {
-        pid->output = pid->outputMaxLimit;
-    }
-    else if (pid->output < pid->outputMinLimit)
-    {
-        pid->output = pid->outputMinLimit;
-    }
-
-    // 更新前两次的误差值，用于下一次计算
-    pid->errorPrePre = pid->errorPre;
-    pid->errorPre    = pid->error;
+    // 外部可能修改过输出值,以它为本次增量的起点
+    pid->kernel.output = pid->output;
+    pid->output        = pid_kernel_compute(&pid->kernel, pid->error);
 
     // 返回更新后的输出值
     return pid->output;
@@ -96,22 +68,57 @@ float incremental_pid_compute(incremental_pid_t* pid, float newActualValue)
  *************************************************************************************/
 void incremental_pid_reset(incremental_pid_t* pid)
 {
-    // 保存不需要重置的配置参数，即PID增益和输出限制以及设定值
-    float kp         = pid->Kp;
-    float ki         = pid->Ki;
-    float kd         = pid->Kd;
-    float setValue   = pid->setValue;
-    float min_output = pid->outputMinLimit;
-    float max_output = pid->outputMaxLimit;
+    // 系数、输出限制和设定值不变,只清除误差历史和输出
+    pid->actualValue = 0;
+    pid->error       = 0;
+    pid->output      = 0;
+    pid_kernel_reset(&pid->kernel);
+}
+
+/**************************************************************************************
+ * @brief   由PID增益计算增量式计算核的系数,并清除误差历史和输出。
+ *
+ * @param   kernel      计算核。
+ * @param   kp          比例系数。
+ * @param   ki          积分系数,按每次计算的周期整定。
+ * @param   kd          微分系数,按每次计算的周期整定。
+ * @param   min_output  输出的最小限制值。
+ * @param   max_output  输出的最大限制值。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void pid_kernel_init(pid_kernel_t* kernel, float kp, float ki, float kd, float min_output, float max_output)
+{
+    pid_kernel_set_gains(kernel, kp, ki, kd);
+    kernel->output_min = min_output;
+    kernel->output_max = max_output;
+    pid_kernel_reset(kernel);
+}
 
-    // 使用memset将PID控制器结构体中的所有成员初始化为零
-    memset(pid, 0, sizeof(incremental_pid_t));
+// 清除误差历史和输出,系数和限幅不变
+void pid_kernel_reset(pid_kernel_t* kernel)
+{
+    kernel->e1     = 0;
+    kernel->e2     = 0;
+    kernel->output = 0;
+}
 
-    // 恢复之前保存的配置参数，确保PID控制器的行为不会改变
-    pid->Kp             = kp;
-    pid->Ki             = ki;
-    pid->Kd             = kd;
-    pid->setValue       = setValue;
-    pid->outputMinLimit = min_output;
-    pid->outputMaxLimit = max_output;
-}
\ No newline at end of file
+/**************************************************************************************
+ * @brief   依次计算连续存放的n个计算核,用于同一节拍运行的多个环路。
+ *
+ * @param   kernel  第一个计算核。
+ * @param   error   n个误差值。
+ * @param   output  n个输出值,可以为NULL。
+ * @param   n       计算核数量。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC void pid_kernel_compute_batch(pid_kernel_t* kernel, const float* error, float* output, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++) {
+        float out = pid_kernel_compute(&kernel[i], error[i]);
+        if (output != NULL) {
+            output[i] = out;
+        }
+    }
+}
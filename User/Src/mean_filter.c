@@ -1,4 +1,5 @@
 #include "mean_filter.h"
+#include "main.h"
 
 /**************************************************************************************
  * @brief   初始化一个均值滤波器。
@@ -13,14 +14,44 @@
  *************************************************************************************/
 void mean_filter_init(mean_filter_t* filter, uint16_t size)
 {
+    mean_filter_init_block(filter, size, 1);
+}
+
+/**************************************************************************************
+ * @brief   初始化一个块模式均值滤波器。
+ *          DMA每次搬运完一个数据块后只更新一次滤波器,窗口中的每个元素是块内
+ *          samples_per_entry个样本的和。size仍以样本数给出,窗口元素数为
+ *          size / samples_per_entry,至少为1。
+ *
+ * @param   filter              指向mean_filter_t结构体的指针，代表要初始化的均值滤波器。
+ * @param   size                滤波器窗口的大小，以样本数计。
+ * @param   samples_per_entry   每个数据块包含的样本数。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void mean_filter_init_block(mean_filter_t* filter, uint16_t size, uint16_t samples_per_entry)
+{
+    if (samples_per_entry == 0)
+    {
+        return;
+    }
+
+    // 把以样本数给出的窗口大小换算为窗口元素数。
+    uint16_t entries = size / samples_per_entry;
+    if (entries == 0)
+    {
+        entries = 1;
+    }
+
     // 检查提供的窗口大小是否有效。窗口大小不能为0，也不能超过预定义的最大窗口尺寸。
-    if (size == 0 || size > MAX_WINDOW_SIZE)
+    if (size == 0 || entries > MAX_WINDOW_SIZE)
     {
         return; // 如果窗口大小无效，则不进行任何操作并退出函数。
     }
 
     // 设置滤波器的窗口大小。
-    filter->window_size = size;
+    filter->window_size       = entries;
+    filter->samples_per_entry = samples_per_entry;
 
     // 初始化环形缓冲区的头部指针。
     filter->head = 0;
@@ -30,7 +61,7 @@ void mean_filter_init(mean_filter_t* filter, uint16_t size)
 
     // 将滤波器窗口的所有元素初始化为0。
     // 这是为了确保在开始使用滤波器时，所有旧的数据都被清空。
-    for (uint16_t i = 0; i < size; ++i)
+    for (uint16_t i = 0; i < entries; ++i)
     {
         filter->window[i] = 0;
     }
@@ -49,6 +80,20 @@ void mean_filter_init(mean_filter_t* filter, uint16_t size)
  * @copyright Copyright (C) 2025 Hong HongLin.  All Rights Reserved.
  *************************************************************************************/
 void mean_filter_update(mean_filter_t* filter, uint16_t new_sample)
+{
+    mean_filter_update_block(filter, new_sample);
+}
+
+/**************************************************************************************
+ * @brief   以一个数据块内样本的和更新均值滤波器的状态。
+ *          块内样本数须与初始化时的samples_per_entry一致。
+ *
+ * @param   filter          指向mean_filter_t结构体的指针，代表要更新的均值滤波器。
+ * @param   block_sum       数据块内样本的和。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC void mean_filter_update_block(mean_filter_t* filter, uint32_t block_sum)
 {
     // 如果滤波器未正确初始化（即窗口大小为0），则不执行任何操作并退出函数。
     if (filter->window_size == 0)
@@ -61,10 +106,10 @@ void mean_filter_update(mean_filter_t* filter, uint16_t new_sample)
     filter->sum -= filter->window[filter->head];
 
     // 更新环形缓冲区中当前位置的样本为新的样本数据。
-    filter->window[filter->head] = new_sample;
+    filter->window[filter->head] = block_sum;
 
     // 添加新样本的值到累积和中，以便之后计算平均值。
-    filter->sum += new_sample;
+    filter->sum += block_sum;
 
     // 移动头部指针到下一个位置。使用模运算确保指针在达到窗口末尾时回绕到起始位置。
     // 这样可以实现一个环形缓冲区，从而有效地管理固定数量的数据点。
@@ -90,5 +135,5 @@ uint16_t mean_filter_calculate_average(const mean_filter_t* filter)
     }
     
     // 计算并返回平均值
-    return (uint16_t)(filter->sum / filter->window_size);
+    return (uint16_t)(filter->sum / ((uint32_t)filter->window_size * filter->samples_per_entry));
 }
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "power_meter.h"
+#include "main.h"
+#include <string.h>
+
+/**************************************************************************************
+ * @brief   初始化功率计。
+ *          设置窗口大小和电压/电流的线性映射参数,清空窗口和累计能量,
+ *          并打开DWT周期计数器用于测量相邻采样对的时间间隔。
+ *
+ * @param   meter   指向power_meter_t结构体的指针。
+ * @param   size    窗口大小,即用于计算平均功率的采样对数量。
+ * @param   v_k     电压线性映射斜率。
+ * @param   v_b     电压线性映射截距。
+ * @param   i_k     电流线性映射斜率。
+ * @param   i_b     电流线性映射截距。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void power_meter_init(power_meter_t* meter, uint16_t size, float v_k, float v_b, float i_k, float i_b)
+{
+    if (size == 0 || size > POWER_METER_MAX_WINDOW_SIZE) {
+        return;
+    }
+
+    memset(meter, 0, sizeof(power_meter_t));
+
+    meter->window_size = size;
+    meter->v_k         = v_k;
+    meter->v_b         = v_b;
+    meter->i_k         = i_k;
+    meter->i_b         = i_b;
+
+    // 能量积分的时间基准
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+// 由Σv、Σi、Σv·i计算n个采样对功率的均值:
+// mean(v·i) = kv·ki·mean(Rv·Ri) + kv·bi·mean(Rv) + bv·ki·mean(Ri) + bv·bi
+static CCMRAM_FUNC float power_meter_mean_power(const power_meter_t* meter, uint32_t sum_v, uint32_t sum_i, uint64_t sum_vi, uint32_t n)
+{
+    const float inv_n = 1.0f / n;
+    float mean_v      = sum_v * inv_n;
+    float mean_i      = sum_i * inv_n;
+    float mean_vi     = (float)sum_vi * inv_n;
+
+    return meter->v_k * meter->i_k * mean_vi + meter->v_k * meter->i_b * mean_v + meter->v_b * meter->i_k * mean_i + meter->v_b * meter->i_b;
+}
+
+/**************************************************************************************
+ * @brief   向功率计输入一个同一时刻采样的电压/电流原始值对。
+ *          整数形式更新窗口内的Σv、Σi、Σv·i,同时按瞬时功率乘以
+ *          与上一个采样对的间隔时间累加能量。在ADC的DMA中断中调用。
+ *
+ * @param   meter   指向power_meter_t结构体的指针。
+ * @param   v_raw   电压原始值。
+ * @param   i_raw   电流原始值。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void power_meter_update(power_meter_t* meter, uint16_t v_raw, uint16_t i_raw)
+{
+    power_meter_update_block(meter, &v_raw, 0, &i_raw, 0, 1);
+}
+
+/**************************************************************************************
+ * @brief   向功率计输入一个DMA数据块内的n个电压/电流原始值对。
+ *          每个采样对依次进入窗口;能量按块内平均功率乘以与上一个数据块的
+ *          间隔时间累加,块内的采样对在同一次中断中处理,无法逐对计时。
+ *
+ * @param   meter       指向power_meter_t结构体的指针。
+ * @param   v_raw       第一个电压原始值的地址。
+ * @param   v_stride    相邻电压原始值的间隔(以uint16_t计),为0时n个采样对共用同一个电压值。
+ * @param   i_raw       第一个电流原始值的地址。
+ * @param   i_stride    相邻电流原始值的间隔(以uint16_t计)。
+ * @param   n           采样对数量。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC void power_meter_update_block(power_meter_t* meter, const uint16_t* v_raw, uint16_t v_stride, const uint16_t* i_raw, uint16_t i_stride, uint16_t n)
+{
+    if (meter->window_size == 0 || n == 0) {
+        return;
+    }
+
+    uint16_t head      = meter->head;
+    uint32_t block_v   = 0;
+    uint32_t block_i   = 0;
+    uint64_t block_vi  = 0;
+    uint32_t window_v  = meter->sum_v;
+    uint32_t window_i  = meter->sum_i;
+    uint64_t window_vi = meter->sum_vi;
+
+    for (uint16_t k = 0; k < n; k++) {
+        uint16_t v     = *v_raw;
+        uint16_t i     = *i_raw;
+        uint32_t vi    = (uint32_t)v * i;
+        uint16_t old_v = meter->v[head];
+        uint16_t old_i = meter->i[head];
+
+        // 移除最旧的采样对,加入新的采样对
+        window_v += v - old_v;
+        window_i += i - old_i;
+        window_vi += vi;
+        window_vi -= (uint32_t)old_v * old_i;
+
+        meter->v[head] = v;
+        meter->i[head] = i;
+
+        block_v += v;
+        block_i += i;
+        block_vi += vi;
+
+        head = (head + 1 == meter->window_size) ? 0 : head + 1;
+        v_raw += v_stride;
+        i_raw += i_stride;
+    }
+
+    meter->sum_v  = window_v;
+    meter->sum_i  = window_i;
+    meter->sum_vi = window_vi;
+    meter->head   = head;
+
+    // 块内平均功率乘以数据块间隔,积分得到能量
+    uint32_t now = DWT->CYCCNT;
+    if (meter->has_last) {
+        uint32_t dt  = now - meter->last_cycle;
+        int32_t p_mw = (int32_t)(power_meter_mean_power(meter, block_v, block_i, block_vi, n) * 1000.0f);
+        meter->energy_acc += (int64_t)p_mw * dt;
+    }
+    meter->last_cycle = now;
+    meter->has_last   = 1;
+}
+
+/**************************************************************************************
+ * @brief   计算窗口内逐采样对功率 v[n]·i[n] 的均值。
+ *
+ * @param   meter   指向power_meter_t结构体的指针。
+ * @return  float   平均功率,单位W
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+CCMRAM_FUNC float power_meter_get_power(const power_meter_t* meter)
+{
+    if (meter->window_size == 0) {
+        return 0.0f;
+    }
+
+    // 64位累加和在DMA中断中更新,拷贝期间关中断避免读到一半
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t sum_v  = meter->sum_v;
+    uint32_t sum_i  = meter->sum_i;
+    uint64_t sum_vi = meter->sum_vi;
+    __set_PRIMASK(primask);
+
+    return power_meter_mean_power(meter, sum_v, sum_i, sum_vi, meter->window_size);
+}
+
+/**************************************************************************************
+ * @brief   获取复位以来的累计能量。
+ *
+ * @param   meter   指向power_meter_t结构体的指针。
+ * @return  float   累计能量,单位J
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+float power_meter_get_energy(const power_meter_t* meter)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    int64_t energy_acc = meter->energy_acc;
+    __set_PRIMASK(primask);
+
+    return (float)energy_acc * (0.001f / (float)SystemCoreClock);
+}
+
+/**************************************************************************************
+ * @brief   清零累计能量,窗口内的平均功率不受影响。
+ *
+ * @param   meter   指向power_meter_t结构体的指针。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void power_meter_reset_energy(power_meter_t* meter)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    meter->energy_acc = 0;
+    __set_PRIMASK(primask);
+}
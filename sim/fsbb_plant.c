@@ -0,0 +1,81 @@
+#include "fsbb_plant.h"
+#include <math.h>
+
+#define FSBB_PLANT_V_MOTOR_MIN (5.0) // 恒功率负载换算电流时的最低母线电压,避免掉电时电流发散
+
+/**************************************************************************************
+ * @brief   按默认参数初始化对象模型:24V裁判系统电源,10uH电感,
+ *          9串2.7V 60F电容组(6.67F, ESR约0.1Ω)。参数可以在初始化后修改。
+ *
+ * @param   plant   对象模型。
+ * @param   v_cap   电容组初始电压,V。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void fsbb_plant_init(fsbb_plant_t *plant, double v_cap)
+{
+    plant->v_source   = 24.0;
+    plant->r_source   = 0.05;
+    plant->inductance = 10e-6;
+    plant->r_loop     = 0.03;
+    plant->capacity   = 60.0 / 9.0;
+    plant->r_esr      = 0.1;
+
+    plant->i_l = 0.0;
+    plant->v_c = v_cap;
+
+    plant->v_motor   = plant->v_source;
+    plant->i_chassis = 0.0;
+    plant->v_cap     = v_cap;
+    plant->i_cap     = 0.0;
+    plant->p_chassis = 0.0;
+}
+
+/**************************************************************************************
+ * @brief   前进一个仿真步长。
+ *          L·di/dt = d_motor·(Vs - Rs·(I_load + d_motor·i)) - d_cap·(Vc + Resr·d_cap·i) - R_loop·i
+ *          步长内Vc与I_load视为常数,i按解析解更新,Vc按步长内的平均电感电流积分。
+ *
+ * @param   plant   对象模型。
+ * @param   d_motor 底盘侧上管导通占空比。
+ * @param   d_cap   电容侧上管导通占空比。
+ * @param   enabled HRTIM输出是否开启,关闭时只有体二极管导通。
+ * @param   p_load  底盘负载功率,W,制动回馈时为负。
+ * @param   dt      步长,s。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void fsbb_plant_step(fsbb_plant_t *plant, double d_motor, double d_cap, uint8_t enabled, double p_load, double dt)
+{
+    double v_bus  = (plant->v_motor > FSBB_PLANT_V_MOTOR_MIN) ? plant->v_motor : FSBB_PLANT_V_MOTOR_MIN;
+    double i_load = p_load / v_bus;
+
+    if (!enabled) {
+        d_motor = 1.0;
+        d_cap   = 1.0;
+    }
+
+    double drive = d_motor * (plant->v_source - plant->r_source * i_load) - d_cap * plant->v_c;
+    double r_eq  = d_motor * d_motor * plant->r_source + d_cap * d_cap * plant->r_esr + plant->r_loop;
+    double i_ss  = drive / r_eq;
+    double tau   = plant->inductance / r_eq;
+    double decay = exp(-dt / tau);
+
+    double i_end  = i_ss + (plant->i_l - i_ss) * decay;
+    double i_mean = i_ss + (plant->i_l - i_ss) * tau / dt * (1.0 - decay);
+
+    // 体二极管只允许电容侧流向底盘侧
+    if (!enabled) {
+        i_end  = (i_end > 0.0) ? 0.0 : i_end;
+        i_mean = (i_mean > 0.0) ? 0.0 : i_mean;
+    }
+
+    plant->i_l = i_end;
+    plant->v_c += d_cap * i_mean * dt / plant->capacity;
+
+    plant->i_cap     = d_cap * i_end;
+    plant->v_cap     = plant->v_c + plant->r_esr * plant->i_cap;
+    plant->i_chassis = i_load + d_motor * i_end;
+    plant->v_motor   = plant->v_source - plant->r_source * plant->i_chassis;
+    plant->p_chassis = plant->v_motor * plant->i_chassis;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef __FSBB_PLANT_H__
+#define __FSBB_PLANT_H__
+
+#include <stdint.h>
+
+// 四开关buck-boost的开关周期平均模型
+//
+//   裁判系统电源 --R_src-- 底盘母线(v_motor) --+-- 底盘负载(恒功率)
+//                                             |
+//                                  底盘侧桥臂(d_motor)
+//                                             |
+//                                        L, R_loop
+//                                             |
+//                                   电容侧桥臂(d_cap)
+//                                             |
+//                                   ESR -- 电容组(v_c)
+//
+// d_motor/d_cap为两个桥臂上管的导通占空比。电感电流由底盘侧流向电容侧为正,
+// 一个仿真步长内占空比和负载电流不变,电感电流按一阶线性方程的解析解更新,步长可以远大于L/R。
+// 输出关闭时开关管的体二极管只允许电容向底盘放电,此时两个上管的体二极管导通。
+typedef struct
+{
+    // 参数
+    double v_source;   // 裁判系统电源电压,V
+    double r_source;   // 电源内阻和线缆电阻,Ω
+    double inductance; // 功率电感,H
+    double r_loop;     // 电感直流电阻与开关管导通电阻,Ω
+    double capacity;   // 电容组容量,F
+    double r_esr;      // 电容组ESR,Ω
+
+    // 状态
+    double i_l; // 电感电流,A
+    double v_c; // 电容组内部电压(不含ESR压降),V
+
+    // 输出,一个步长结束时的值
+    double v_motor;   // 底盘母线电压
+    double i_chassis; // 裁判系统电源输出电流,即底盘电流采样
+    double v_cap;     // 电容组端电压
+    double i_cap;     // 电容组电流,充电为正
+    double p_chassis; // 裁判系统电源输出功率
+} fsbb_plant_t;
+
+extern void fsbb_plant_init(fsbb_plant_t *plant, double v_cap);
+extern void fsbb_plant_step(fsbb_plant_t *plant, double d_motor, double d_cap, uint8_t enabled, double p_load, double dt);
+
+#endif // !__FSBB_PLANT_H__
@@ -0,0 +1,494 @@
+/**************************************************************************************
+ * @file    fsbb_sim.c
+ * @brief   四开关buck-boost的主机闭环仿真。
+ *          User/Src下的固件代码在主机上编译,与开关周期平均的对象模型组成闭环:
+ *          ADC触发、TIM6控制环、TIM16通信定时器、上位机CAN命令按板上的周期作为离散事件调度,
+ *          两个事件之间对象模型以不变的占空比解析求解。
+ *          输出每段工况的功率调节时间、超出功率上限的峰值和能量,用于比较控制器修改前后的表现。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+#include "sim_hal.h"
+#include "fsbb_plant.h"
+#include "load_profile.h"
+#include "adc.h"
+#include "tim.h"
+#include "fsbb_pwm.h"
+#include "analog_signal.h"
+#include "fault_comp.h"
+#include "comm.h"
+#include "cycle_profiler.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if (FSBB_CONTROL_MODE == FSBB_CONTROL_MODE_CURRENT)
+    #error "the averaged plant model only covers voltage mode control"
+#endif
+
+#if (FSBB_CURRENT_COMP_FMAC)
+    #error "FMAC is not emulated, run the compensator on the float backend"
+#endif
+#if (FSBB_PWM_BURST_DMA)
+    #error "HRTIM burst DMA is not emulated, write the compare registers directly"
+#endif
+
+#define SIM_CAN_PERIOD_S      (0.001) // 上位机命令周期
+#define SIM_BOOT_S            (0.1)   // 上位机在此之后才开启输出,滤波窗口已填满
+#define SIM_REFEREE_BUFFER_J  (60.0)  // 裁判系统缓冲能量
+#define SIM_ADC_FIT_POINTS    (4096U) // 拟合ADC换算关系的点数
+#define SIM_ADC_SUM_MAX       (4095.0 * 16.0)
+#define SIM_OUTPUTS_ALL       (HRTIM_OUTPUT_TA1 | HRTIM_OUTPUT_TA2 | HRTIM_OUTPUT_TD1 | HRTIM_OUTPUT_TD2)
+
+// fsbb_pwm.c中的控制环中间量,只用于记录波形
+extern float calculatedChassisPower;
+extern float pid_power_output;
+extern float general_duty;
+
+// 16倍过采样和与实际值的线性关系:value = k * sum + b
+typedef struct
+{
+    double k;
+    double b;
+} sim_adc_map_t;
+
+// 一段工况的统计
+typedef struct
+{
+    double t_start;
+    double over_peak;   // 超出功率上限的峰值,W
+    double over_energy; // 超出功率上限的能量,J
+    float *power;       // 每次ADC触发时的底盘功率
+    uint32_t count;
+    uint32_t capacity;
+} sim_segment_stat_t;
+
+typedef struct
+{
+    const load_profile_t *profile;
+    double duration;   // 仿真时长,s
+    double v_cap_init; // 电容初始电压,V
+    double band;       // 调节时间的误差带,W
+    double noise;      // ADC噪声,12位LSB有效值
+    double trace_step; // 波形记录间隔,s
+    const char *trace_path;
+} sim_option_t;
+
+static sim_adc_map_t sim_adc_map[4];
+static uint64_t sim_rng_state = 0x9E3779B97F4A7C15ULL;
+
+// xorshift64*,[0, 1)均匀分布
+static inline double sim_rand_uniform(void)
+{
+    sim_rng_state ^= sim_rng_state >> 12;
+    sim_rng_state ^= sim_rng_state << 25;
+    sim_rng_state ^= sim_rng_state >> 27;
+    return ((sim_rng_state * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// 4个均匀分布之和近似正态分布,有效值为1。每次ADC触发都要调用,不使用Box-Muller的log/cos
+static inline double sim_rand_gauss(void)
+{
+    return (sim_rand_uniform() + sim_rand_uniform() + sim_rand_uniform() + sim_rand_uniform() - 2.0) * 1.7320508075688772;
+}
+
+/**************************************************************************************
+ * @brief   由固件的get_adc_raw_from_value拟合实际值与16倍过采样和的线性关系,
+ *          仿真使用的换算与当前板子的校准数据一致,不在仿真中另存一份校准表。
+ *          拟合只使用未被限幅的点,取整误差在数千个点上平均后可以忽略。
+ *
+ * @param   signal  模拟信号通道。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void sim_adc_fit(adc_signal_t signal)
+{
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    uint32_t n = 0;
+
+    for (uint32_t k = 0; k < SIM_ADC_FIT_POINTS; k++) {
+        double value = -60.0 + 120.0 * k / SIM_ADC_FIT_POINTS;
+        uint16_t raw = get_adc_raw_from_value(signal, (float)value);
+        if (raw == 0 || raw == 4095) {
+            continue;
+        }
+        double x = raw * 16.0;
+        sx += x;
+        sy += value;
+        sxx += x * x;
+        sxy += x * value;
+        n++;
+    }
+
+    double k              = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    sim_adc_map[signal].k = k;
+    sim_adc_map[signal].b = (sy - k * sx) / n;
+}
+
+// 实际值换算为16倍过采样和,16次转换的噪声合成为4倍的有效值
+static uint16_t sim_adc_sum(adc_signal_t signal, double value, double noise)
+{
+    double sum = (value - sim_adc_map[signal].b) / sim_adc_map[signal].k;
+    if (noise > 0.0) {
+        sum += sim_rand_gauss() * noise * 4.0;
+    }
+    sum = (sum < 0.0) ? 0.0 : (sum > SIM_ADC_SUM_MAX) ? SIM_ADC_SUM_MAX : sum;
+    return (uint16_t)(sum + 0.5);
+}
+
+// 一次HRTIM_TRG1/TRG3触发:比较器、ADC2、ADC3、ADC1,与板上ADC序列结束的先后一致
+static void sim_adc_trigger(const fsbb_plant_t *plant, double noise)
+{
+    uint16_t v_motor   = sim_adc_sum(ADC_SIGNAL_V_MOTOR, plant->v_motor, noise);
+    uint16_t i_chassis = sim_adc_sum(ADC_SIGNAL_I_CHASSIS, plant->i_chassis, noise);
+    uint16_t v_cap     = sim_adc_sum(ADC_SIGNAL_V_CAP, plant->v_cap, noise);
+    uint16_t i_cap     = sim_adc_sum(ADC_SIGNAL_I_CAP, plant->i_cap, noise);
+
+    sim_comp_input(COMP5, v_motor >> 4);
+    sim_comp_input(COMP1, i_cap >> 4);
+
+    const uint32_t adc2_ch[4] = {ADC_CHANNEL_12, ADC_CHANNEL_13, ADC_CHANNEL_12, ADC_CHANNEL_13};
+    const uint16_t adc2_v[4]  = {i_cap, v_cap, i_cap, v_cap};
+    sim_adc_sample(&hadc2, adc2_ch, adc2_v, hadc2.Init.NbrOfConversion);
+
+#if (ADC_CHASSIS_DUAL_SIMULT)
+    const uint32_t adc3_ch[2] = {ADC_CHANNEL_5, ADC_CHANNEL_3};
+    const uint16_t adc3_v[2]  = {v_motor, i_chassis};
+    sim_adc_sample(&hadc3, adc3_ch, adc3_v, 2);
+#else
+    const uint32_t adc3_ch[2] = {ADC_CHANNEL_5, ADC_CHANNEL_5};
+    const uint16_t adc3_v[2]  = {v_motor, v_motor};
+    sim_adc_sample(&hadc3, adc3_ch, adc3_v, 2);
+
+    const uint32_t adc1_ch[2] = {ADC_CHANNEL_11, ADC_CHANNEL_11};
+    const uint16_t adc1_v[2]  = {i_chassis, i_chassis};
+    sim_adc_sample(&hadc1, adc1_ch, adc1_v, 2);
+#endif
+}
+
+static void sim_segment_push(sim_segment_stat_t *stat, float power)
+{
+    if (stat->count == stat->capacity) {
+        stat->capacity = stat->capacity ? stat->capacity * 2 : 65536;
+        stat->power    = realloc(stat->power, stat->capacity * sizeof(float));
+        if (stat->power == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(2);
+        }
+    }
+    stat->power[stat->count++] = power;
+}
+
+/**************************************************************************************
+ * @brief   结束一段工况的统计并打印一行。
+ *          稳态值取本段最后10%时间内底盘功率的均值,调节时间为功率最后一次
+ *          离开稳态值±band的时刻;本段结束时仍在误差带之外则认为未稳定。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+static void sim_segment_finish(sim_segment_stat_t *stat, uint32_t index, const load_segment_t *segment,
+                               double band, double *settle_max)
+{
+    if (stat->count == 0) {
+        return;
+    }
+
+    uint32_t tail = stat->count / 10 + 1;
+    double final  = 0.0;
+    for (uint32_t n = stat->count - tail; n < stat->count; n++) {
+        final += stat->power[n];
+    }
+    final /= tail;
+
+    int64_t last_out = -1;
+    for (uint32_t n = 0; n < stat->count; n++) {
+        if (fabs(stat->power[n] - final) > band) {
+            last_out = n;
+        }
+    }
+
+    char settle[32];
+    if (last_out == (int64_t)stat->count - 1) {
+        snprintf(settle, sizeof(settle), "%10s", "-");
+    } else {
+        double t = (last_out + 1) * SIM_ADC_TRIGGER_S * 1000.0;
+        snprintf(settle, sizeof(settle), "%10.1f", t);
+        if (t > *settle_max) {
+            *settle_max = t;
+        }
+    }
+
+    printf("%4u %9.3f %8.1f %8u %9.2f %s %11.2f %9.3f\n", index, stat->t_start, segment->load_power,
+           segment->power_limit, final, settle, stat->over_peak, stat->over_energy);
+
+    stat->count       = 0;
+    stat->over_peak   = 0.0;
+    stat->over_energy = 0.0;
+}
+
+static void sim_usage(const char *prog)
+{
+    printf("usage: %s [-p profile] [-t seconds] [-v v_cap] [-b band] [-n noise] [-o trace.csv] [-d trace_ms]\n"
+           "  -p  load profile, default step\n"
+           "  -t  simulated time in s, default one pass of the profile\n"
+           "  -v  initial cap voltage in V, default 22\n"
+           "  -b  settling band in W, default 2\n"
+           "  -n  ADC noise in 12-bit LSB rms, default 1\n"
+           "  -o  write a CSV trace\n"
+           "  -d  trace interval in ms, default 1\n"
+           "profiles:\n",
+           prog);
+    for (uint32_t n = 0; n < load_profile_num; n++) {
+        printf("  %-8s %s\n", load_profiles[n].name, load_profiles[n].description);
+    }
+}
+
+static int sim_parse(int argc, char **argv, sim_option_t *opt)
+{
+    int c;
+
+    opt->profile    = &load_profiles[0];
+    opt->duration   = 0.0;
+    opt->v_cap_init = 22.0;
+    opt->band       = 2.0;
+    opt->noise      = 1.0;
+    opt->trace_step = 0.001;
+    opt->trace_path = NULL;
+
+    while ((c = getopt(argc, argv, "p:t:v:b:n:o:d:h")) != -1) {
+        switch (c) {
+            case 'p':
+                opt->profile = load_profile_find(optarg);
+                if (opt->profile == NULL) {
+                    fprintf(stderr, "unknown profile %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case 't':
+                opt->duration = atof(optarg);
+                break;
+            case 'v':
+                opt->v_cap_init = atof(optarg);
+                break;
+            case 'b':
+                opt->band = atof(optarg);
+                break;
+            case 'n':
+                opt->noise = atof(optarg);
+                break;
+            case 'o':
+                opt->trace_path = optarg;
+                break;
+            case 'd':
+                opt->trace_step = atof(optarg) / 1000.0;
+                break;
+            default:
+                sim_usage(argv[0]);
+                return -1;
+        }
+    }
+
+    if (opt->duration <= 0.0) {
+        opt->duration = load_profile_duration(opt->profile);
+    }
+    if (opt->trace_step <= 0.0) {
+        opt->trace_step = 0.001;
+    }
+    return 0;
+}
+
+// 与main.c中的初始化顺序一致
+static void sim_firmware_init(void)
+{
+    sim_hal_init();
+#if (CYCLE_PROFILER_ENABLE)
+    cycle_profiler_init();
+#endif
+    my_pid_init();
+    fsbb_pwm_init();
+    BSP_ADC_Convert_Start();
+    BSP_FAULT_Init();
+    comm_init();
+    sim_hal_sync();
+}
+
+int main(int argc, char **argv)
+{
+    sim_option_t opt;
+    if (sim_parse(argc, argv, &opt) != 0) {
+        return 2;
+    }
+
+    FILE *trace = NULL;
+    if (opt.trace_path != NULL) {
+        trace = fopen(opt.trace_path, "w");
+        if (trace == NULL) {
+            perror(opt.trace_path);
+            return 2;
+        }
+        fprintf(trace, "t,load,limit,p_chassis,v_motor,i_chassis,v_cap,i_cap,i_l,d_motor,d_cap,enabled,"
+                       "fw_power,fw_current_ref,fw_factor\n");
+    }
+
+    fsbb_plant_t plant;
+    fsbb_plant_init(&plant, opt.v_cap_init);
+    sim_firmware_init();
+    for (adc_signal_t s = ADC_SIGNAL_V_MOTOR; s <= ADC_SIGNAL_I_CAP; s++) {
+        sim_adc_fit(s);
+    }
+
+    const load_profile_t *profile = opt.profile;
+    uint32_t seg                  = 0;
+    uint32_t seg_index            = 0;
+    double seg_end                = profile->segments[0].duration;
+
+    // 各事件的计数,下一次事件时间 = 计数 * 周期,不累积舍入误差
+    uint64_t n_tim6 = 0, n_tim16 = 0, n_can = 0, n_trace = 0;
+    double t_adc = 0.0; // 开关周期可变,ADC触发时刻逐次累加
+    double t = 0.0;
+
+    sim_segment_stat_t stat = {0};
+    double buffer           = SIM_REFEREE_BUFFER_J;
+    double buffer_min       = SIM_REFEREE_BUFFER_J;
+    double over_peak_max    = 0.0;
+    double over_energy      = 0.0;
+    double settle_max       = 0.0;
+    double burst_time       = 0.0;
+    double switching_time   = 0.0; // 开关的时间,s
+    double switching_cycles = 0.0; // 开关周期数
+    double v_cap_min = plant.v_cap, v_cap_max = plant.v_cap;
+
+    printf("profile %s, %.1f s, v_cap %.1f V, band %.1f W, noise %.1f LSB\n", profile->name, opt.duration,
+           opt.v_cap_init, opt.band, opt.noise);
+    printf("%4s %9s %8s %8s %9s %10s %11s %9s\n", "seg", "t_start", "load_W", "limit_W", "final_W", "settle_ms",
+           "over_pk_W", "over_J");
+
+    struct timespec wall_start, wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+
+    while (t < opt.duration) {
+        const load_segment_t *segment = &profile->segments[seg];
+
+        double t_tim6  = n_tim6 * SIM_TIM6_PERIOD_S;
+        double t_tim16 = n_tim16 * SIM_TIM16_PERIOD_S;
+        double t_can   = n_can * SIM_CAN_PERIOD_S;
+        double t_trace = n_trace * opt.trace_step;
+
+        double t_next = seg_end;
+        t_next        = (t_adc < t_next) ? t_adc : t_next;
+        t_next        = (t_tim6 < t_next) ? t_tim6 : t_next;
+        t_next        = (t_tim16 < t_next) ? t_tim16 : t_next;
+        t_next        = (t_can < t_next) ? t_can : t_next;
+        t_next        = (t_trace < t_next) ? t_trace : t_next;
+        t_next        = (opt.duration < t_next) ? opt.duration : t_next;
+
+        // 两个事件之间对象模型以当前的比较值和输出状态前进
+        if (t_next > t) {
+            double dt       = t_next - t;
+            uint8_t enabled = ((sim_hal_outputs() & SIM_OUTPUTS_ALL) == SIM_OUTPUTS_ALL) && !sim_hrtim_burst();
+            burst_time += sim_hrtim_burst() ? dt : 0.0;
+            if (enabled) {
+                switching_time += dt;
+                switching_cycles += dt * SIM_HRTIM_CLOCK_HZ / HRTIM1->sMasterRegs.MPER;
+            }
+            fsbb_plant_step(&plant, sim_hrtim_duty(HRTIM_TIMERINDEX_TIMER_A), sim_hrtim_duty(HRTIM_TIMERINDEX_TIMER_D),
+                            enabled, segment->load_power, dt);
+
+            double over = plant.p_chassis - segment->power_limit;
+            if (over > 0.0) {
+                stat.over_energy += over * dt;
+                over_energy += over * dt;
+                if (over > stat.over_peak) {
+                    stat.over_peak = over;
+                }
+                if (over > over_peak_max) {
+                    over_peak_max = over;
+                }
+            }
+            buffer -= over * dt;
+            buffer     = (buffer > SIM_REFEREE_BUFFER_J) ? SIM_REFEREE_BUFFER_J : buffer;
+            buffer_min = (buffer < buffer_min) ? buffer : buffer_min;
+            v_cap_min  = (plant.v_cap < v_cap_min) ? plant.v_cap : v_cap_min;
+            v_cap_max  = (plant.v_cap > v_cap_max) ? plant.v_cap : v_cap_max;
+
+            t = t_next;
+            sim_hal_set_time(t);
+        }
+
+        if (t >= seg_end) {
+            sim_segment_finish(&stat, seg_index, segment, opt.band, &settle_max);
+            seg = (seg + 1) % profile->count;
+            seg_index++;
+            seg_end += profile->segments[seg].duration;
+            stat.t_start = t;
+            continue;
+        }
+        if (t >= opt.duration) {
+            break;
+        }
+
+        if (t >= t_can) {
+            sim_can_receive(segment->power_limit, t >= SIM_BOOT_S);
+            n_can++;
+        }
+        if (t >= t_adc) {
+            sim_adc_trigger(&plant, opt.noise);
+            sim_segment_push(&stat, (float)plant.p_chassis);
+            t_adc += SIM_ADC_TRIGGER_S;
+        }
+        if (t >= t_tim6) {
+#if (FSBB_LOOP_TRIGGER == FSBB_LOOP_TRIGGER_TIM6)
+            HAL_TIM_PeriodElapsedCallback(&htim6);
+            sim_hal_sync();
+#endif
+            n_tim6++;
+        }
+        if (t >= t_tim16) {
+            HAL_TIM_PeriodElapsedCallback(&htim16);
+            sim_hal_sync();
+            n_tim16++;
+        }
+        if (t >= t_trace) {
+            if (trace != NULL) {
+                fprintf(trace, "%.6f,%.1f,%u,%.3f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%u,%.3f,%.4f,%.4f\n", t,
+                        segment->load_power, segment->power_limit, plant.p_chassis, plant.v_motor, plant.i_chassis,
+                        plant.v_cap, plant.i_cap, plant.i_l, sim_hrtim_duty(HRTIM_TIMERINDEX_TIMER_A),
+                        sim_hrtim_duty(HRTIM_TIMERINDEX_TIMER_D),
+                        (sim_hal_outputs() & SIM_OUTPUTS_ALL) == SIM_OUTPUTS_ALL, calculatedChassisPower,
+                        pid_power_output, general_duty);
+            }
+            n_trace++;
+        }
+    }
+    sim_segment_finish(&stat, seg_index, &profile->segments[seg], opt.band, &settle_max);
+    free(stat.power);
+
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    double wall = (wall_end.tv_sec - wall_start.tv_sec) + (wall_end.tv_nsec - wall_start.tv_nsec) * 1e-9;
+
+    if (trace != NULL) {
+        fclose(trace);
+    }
+
+    uint8_t fault = fsbb_pwm_fault_get();
+    printf("settle max %.1f ms, over-limit peak %.2f W, over-limit energy %.3f J, referee buffer min %.2f J\n",
+           settle_max, over_peak_max, over_energy, buffer_min);
+    printf("v_cap %.2f ~ %.2f V, fault %u, adc watchdog 0x%02x (derated 0x%02x), comparator 0x%02x (derated 0x%02x)\n",
+           v_cap_min, v_cap_max, fault, (unsigned)get_adc_watchdog_trip_source(), (unsigned)get_adc_watchdog_derated(),
+           (unsigned)get_fault_comp_trip_source(), (unsigned)get_fault_comp_derated());
+    printf("energy since output enable: chassis %.1f J, cap %.1f J\n", get_energy_chassis(), get_energy_cap());
+    float burst_base, burst_saved;
+    fsbb_burst_get_power(&burst_base, &burst_saved);
+    printf("burst %.1f %% of time, %u entries, net input %.2f W before entry, %.3f W saved (measured)\n",
+           100.0 * burst_time / t, (unsigned)fsbb_burst_get_entries(), burst_base, burst_saved);
+    printf("switching %.1f s, mean frequency %.1f kHz, %.0f cycles\n", switching_time,
+           (switching_time > 0.0) ? switching_cycles / switching_time / 1000.0 : 0.0, switching_cycles);
+    printf("%.1f s simulated in %.3f s wall, %.0fx real time\n", t, wall, (wall > 0.0) ? t / wall : 0.0);
+
+    // 缓冲能量耗尽(板上会被裁判系统断电)或硬件保护触发时返回非零
+    return (buffer_min <= 0.0 || fault) ? 1 : 0;
+}
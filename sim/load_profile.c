@@ -0,0 +1,64 @@
+#include "load_profile.h"
+#include <string.h>
+
+#define SEGMENTS(x) (x), (sizeof(x) / sizeof((x)[0]))
+
+// 负载阶跃:轻载、重载、超过电容放电能力的重载、制动回馈
+static const load_segment_t profile_step[] = {
+    {2.0, 20.0, 60},
+    {3.0, 150.0, 60},
+    {3.0, 20.0, 60},
+    {3.0, 250.0, 60},
+    {3.0, -40.0, 60},
+    {2.0, 60.0, 60},
+};
+
+// 步兵冲刺:巡航、起步加速、刹车,周期重复
+static const load_segment_t profile_sprint[] = {
+    {1.4, 40.0, 80},
+    {0.6, 300.0, 80},
+    {0.2, -80.0, 80},
+};
+
+// 功率上限阶跃:负载不变,裁判系统等级变化时上位机改变功率上限
+static const load_segment_t profile_limit[] = {
+    {3.0, 80.0, 45},
+    {3.0, 80.0, 100},
+    {3.0, 80.0, 60},
+    {3.0, 80.0, 120},
+    {3.0, 80.0, 45},
+};
+
+// 静止充电:电容从低电压充满,经过电容电压上限环接管
+static const load_segment_t profile_charge[] = {
+    {60.0, 10.0, 120},
+};
+
+const load_profile_t load_profiles[] = {
+    {"step", "load steps 20/150/20/250/-40/60 W at 60 W limit", SEGMENTS(profile_step)},
+    {"sprint", "cruise 40 W, accelerate 300 W, brake -80 W at 80 W limit", SEGMENTS(profile_sprint)},
+    {"limit", "80 W load, power limit steps 45/100/60/120/45 W", SEGMENTS(profile_limit)},
+    {"charge", "10 W load, 120 W limit, charge until the cap voltage limit", SEGMENTS(profile_charge)},
+};
+
+const uint32_t load_profile_num = sizeof(load_profiles) / sizeof(load_profiles[0]);
+
+const load_profile_t *load_profile_find(const char *name)
+{
+    for (uint32_t n = 0; n < load_profile_num; n++) {
+        if (strcmp(load_profiles[n].name, name) == 0) {
+            return &load_profiles[n];
+        }
+    }
+    return NULL;
+}
+
+// 工况一次完整重复的长度,s
+double load_profile_duration(const load_profile_t *profile)
+{
+    double duration = 0.0;
+    for (uint32_t n = 0; n < profile->count; n++) {
+        duration += profile->segments[n].duration;
+    }
+    return duration;
+}
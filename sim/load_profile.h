@@ -0,0 +1,30 @@
+#pragma once
+#ifndef __LOAD_PROFILE_H__
+#define __LOAD_PROFILE_H__
+
+#include <stdint.h>
+
+// 底盘负载工况的一段:持续时间内负载功率和上位机下发的功率上限不变
+typedef struct
+{
+    double duration;     // 持续时间,s
+    double load_power;   // 底盘负载功率,W,制动回馈时为负
+    uint8_t power_limit; // 经CAN下发的底盘功率上限,W
+} load_segment_t;
+
+// 一个工况由若干段组成,仿真时间超过一个工况的长度时从头重复
+typedef struct
+{
+    const char *name;
+    const char *description;
+    const load_segment_t *segments;
+    uint32_t count;
+} load_profile_t;
+
+extern const load_profile_t load_profiles[];
+extern const uint32_t load_profile_num;
+
+extern const load_profile_t *load_profile_find(const char *name);
+extern double load_profile_duration(const load_profile_t *profile);
+
+#endif // !__LOAD_PROFILE_H__
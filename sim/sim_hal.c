@@ -0,0 +1,594 @@
+#include "sim_hal.h"
+#include "adc.h"
+#include "hrtim.h"
+#include "tim.h"
+#include "fdcan.h"
+#include "analog_signal.h"
+#include "fault_comp.h"
+#include "comm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+sim_periph_t sim_periph;
+
+uint32_t SystemCoreClock = (uint32_t)SIM_SYSCLK_HZ;
+
+// Core/Src中由CubeMX生成的句柄,主机上只保留固件用到的字段
+ADC_HandleTypeDef hadc1;
+ADC_HandleTypeDef hadc2;
+ADC_HandleTypeDef hadc3;
+DMA_HandleTypeDef hdma_adc1;
+DMA_HandleTypeDef hdma_adc2;
+DMA_HandleTypeDef hdma_adc3;
+HRTIM_HandleTypeDef hhrtim1;
+TIM_HandleTypeDef htim6;
+TIM_HandleTypeDef htim16;
+FDCAN_HandleTypeDef hfdcan1;
+
+#define SIM_ADC_NUM (5U)
+#define SIM_AWD_NUM (3U)
+
+// 一个ADC的DMA循环缓冲,由HAL_ADC_Start_DMA/HAL_ADCEx_MultiModeStart_DMA登记
+typedef struct
+{
+    void *buffer;
+    uint32_t length; // 传输次数
+    uint32_t pos;    // 下一次传输的位置
+    uint8_t word;    // 双重模式,每次传输一个32位采样对
+} sim_adc_dma_t;
+
+// 一个模拟看门狗,阈值为12位,与HAL_ADC_AnalogWDGConfig的参数相同
+typedef struct
+{
+    uint8_t used;
+    uint32_t channel;
+    uint32_t high;
+    uint32_t low;
+} sim_adc_awd_t;
+
+// 比较器与阈值DAC、HRTIM故障输入的连接,与fault_comp.c中的固定连接一致
+typedef struct
+{
+    COMP_TypeDef *comp;
+    DAC_TypeDef *dac;
+    uint32_t timer_fault; // HRTIM_FLTR_FLTxEN
+    uint32_t fault_flag;  // HRTIM_ISR_FLTx
+} sim_comp_route_t;
+
+static sim_adc_dma_t sim_adc_dma[SIM_ADC_NUM];
+static sim_adc_awd_t sim_adc_awd[SIM_ADC_NUM][SIM_AWD_NUM];
+static const uint32_t sim_awd_flags[SIM_AWD_NUM] = {ADC_ISR_AWD1, ADC_ISR_AWD2, ADC_ISR_AWD3};
+
+static const sim_comp_route_t sim_comp_routes[] = {
+    {COMP1, DAC3, HRTIM_FLTR_FLT4EN, HRTIM_ISR_FLT4},
+    {COMP5, DAC4, HRTIM_FLTR_FLT6EN, HRTIM_ISR_FLT6},
+};
+
+static uint32_t sim_outputs     = 0; // 已开启的HRTIM输出,HRTIM_OUTPUT_xxx
+static uint32_t sim_fault_input = 0; // 当前有效的故障输入,HRTIM_ISR_FLTx
+static uint32_t sim_tick        = 0;
+
+static uint8_t sim_can_rx_data[8];
+static uint8_t sim_can_tx_data[8];
+
+// ADC触发周期,秒,由固件写入的主定时器周期和HRTIM_TRG1后分频决定
+double sim_adc_trigger_period(void)
+{
+    uint32_t div = ((HRTIM1->sCommonRegs.ADCPS1 & HRTIM_ADCPS1_AD1PSC) >> HRTIM_ADCPS1_AD1PSC_Pos) + 1U;
+
+    return (double)HRTIM1->sMasterRegs.MPER * div / SIM_HRTIM_CLOCK_HZ;
+}
+
+/**************************************************************************************
+ * @brief   设置外设寄存器和句柄的初值,相当于板上的MX_xxx_Init。
+ *          只设置固件在主机上会读到的部分:句柄的实例、ADC的DMA句柄和序列长度、
+ *          HRTIM周期与ADC触发后分频、DAC就绪标志。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void sim_hal_init(void)
+{
+    memset(&sim_periph, 0, sizeof(sim_periph));
+    memset(sim_adc_dma, 0, sizeof(sim_adc_dma));
+    memset(sim_adc_awd, 0, sizeof(sim_adc_awd));
+    sim_outputs     = 0;
+    sim_fault_input = 0;
+    sim_tick        = 0;
+
+    ADC_HandleTypeDef *hadc[3] = {&hadc1, &hadc2, &hadc3};
+    DMA_HandleTypeDef *hdma[3] = {&hdma_adc1, &hdma_adc2, &hdma_adc3};
+    const uint32_t seq_len[3]  = {2, 4, 2};
+    for (uint32_t n = 0; n < 3; n++) {
+        memset(hadc[n], 0, sizeof(*hadc[n]));
+        memset(hdma[n], 0, sizeof(*hdma[n]));
+        hadc[n]->Instance             = &sim_periph.adc[n];
+        hadc[n]->DMA_Handle           = hdma[n];
+        hadc[n]->Init.NbrOfConversion = seq_len[n];
+        hdma[n]->Parent               = hadc[n];
+        hdma[n]->DmaBaseAddress       = DMA1;
+        hdma[n]->ChannelIndex         = n * 4U; // DMA1_Channel1~3
+    }
+
+    memset(&hhrtim1, 0, sizeof(hhrtim1));
+    hhrtim1.Instance                                    = HRTIM1;
+    HRTIM1->sMasterRegs.MPER                            = SIM_HRTIM_PERIOD;
+    HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].PERxR = SIM_HRTIM_PERIOD;
+    HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].PERxR = SIM_HRTIM_PERIOD;
+    HRTIM1->sCommonRegs.ADCPS1 = ((SIM_ADC_TRIGGER_DIV - 1) << HRTIM_ADCPS1_AD1PSC_Pos) |
+                                 ((SIM_ADC_TRIGGER_DIV - 1) << HRTIM_ADCPS1_AD3PSC_Pos);
+
+    htim6.Instance   = TIM6;
+    htim16.Instance  = TIM16;
+    hfdcan1.Instance = FDCAN1;
+
+    for (uint32_t n = 0; n < 4; n++) {
+        sim_periph.dac[n].SR = DAC_SR_DAC1RDY | DAC_SR_DAC2RDY;
+    }
+}
+
+// 仿真时间,秒。HAL_GetTick和DWT周期计数器随之前进
+void sim_hal_set_time(double t)
+{
+    sim_tick    = (uint32_t)(t * 1000.0);
+    DWT->CYCCNT = (uint32_t)(uint64_t)(t * SIM_SYSCLK_HZ);
+}
+
+/**************************************************************************************
+ * @brief   按硬件行为处理固件写入的只写寄存器:ODISR关闭输出,ICR清除HRTIM中断标志,
+ *          BMTRGR的软件触发启动突发模式。
+ *          每次调用固件代码之后调用。
+ *
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void sim_hal_sync(void)
+{
+    sim_outputs &= ~HRTIM1->sCommonRegs.ODISR;
+    HRTIM1->sCommonRegs.ODISR = 0;
+    HRTIM1->sCommonRegs.ISR &= ~HRTIM1->sCommonRegs.ICR;
+    HRTIM1->sCommonRegs.ICR = 0;
+
+    if ((HRTIM1->sCommonRegs.BMTRGR & HRTIM_BMTRGR_SW) && (HRTIM1->sCommonRegs.BMCR & HRTIM_BMCR_BME)) {
+        HRTIM1->sCommonRegs.BMCR |= HRTIM_BMCR_BMSTAT;
+    }
+    HRTIM1->sCommonRegs.BMTRGR &= ~HRTIM_BMTRGR_SW;
+    if (!(HRTIM1->sCommonRegs.BMCR & HRTIM_BMCR_BME)) {
+        HRTIM1->sCommonRegs.BMCR &= ~HRTIM_BMCR_BMSTAT;
+    }
+}
+
+// 是否处于突发模式。突发周期内保留的少量开关周期按关断处理
+uint8_t sim_hrtim_burst(void)
+{
+    return (HRTIM1->sCommonRegs.BMCR & HRTIM_BMCR_BMSTAT) != 0;
+}
+
+uint32_t sim_hal_outputs(void)
+{
+    return sim_outputs;
+}
+
+/**************************************************************************************
+ * @brief   由比较值计算一个桥臂上管的导通占空比。
+ *          TA1/TD1在比较1置位、比较3复位,为高时下管导通,死区忽略不计。
+ *          Timer A/D由主定时器周期复位,实际开关周期是主定时器的周期。
+ *
+ * @param   timer   HRTIM_TIMERINDEX_TIMER_A或HRTIM_TIMERINDEX_TIMER_D。
+ * @return  上管导通占空比,0~1。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+float sim_hrtim_duty(uint32_t timer)
+{
+    int32_t period = (int32_t)HRTIM1->sMasterRegs.MPER;
+    int32_t low    = (int32_t)HRTIM1->sTimerxRegs[timer].CMP3xR - (int32_t)HRTIM1->sTimerxRegs[timer].CMP1xR;
+
+    if (low < 0) {
+        low += period;
+    }
+    return 1.0f - (float)low / (float)period;
+}
+
+// 写1清零的ADC中断标志:固件写入ISR的值就是要清除的标志
+static void sim_adc_isr_w1c(ADC_TypeDef *adc, uint32_t before)
+{
+    adc->ISR = before & ~adc->ISR;
+}
+
+static void sim_adc_watchdog(uint32_t index, const uint32_t *channels, const uint16_t *values, uint32_t n)
+{
+    ADC_TypeDef *adc = &sim_periph.adc[index];
+
+    // 16倍过采样时看门狗比较过采样和的高12位
+    for (uint32_t k = 0; k < n; k++) {
+        uint32_t raw = values[k] >> 4;
+        for (uint32_t w = 0; w < SIM_AWD_NUM; w++) {
+            const sim_adc_awd_t *awd = &sim_adc_awd[index][w];
+            if (awd->used && awd->channel == channels[k] && (raw > awd->high || raw < awd->low)) {
+                adc->ISR |= sim_awd_flags[w];
+            }
+        }
+    }
+
+    if (adc->ISR & adc->IER & (ADC_ISR_AWD1 | ADC_ISR_AWD2 | ADC_ISR_AWD3)) {
+        uint32_t isr2 = ADC2->ISR;
+        uint32_t isr3 = ADC3->ISR;
+        BSP_ADC_Watchdog_IRQHandler();
+        sim_hal_sync();
+        sim_adc_isr_w1c(ADC2, isr2);
+        sim_adc_isr_w1c(ADC3, isr3);
+    }
+}
+
+/**************************************************************************************
+ * @brief   一次触发的序列转换结果经DMA写入固件登记的缓冲区。
+ *          到达半缓冲或缓冲末尾时置位DMA标志,并按ADC_DMA_FAST_IRQ调用相应的中断入口。
+ *          模拟看门狗先于DMA中断处理,与板上的中断优先级一致。
+ *
+ * @param   hadc        ADC句柄。
+ * @param   channels    序列中每个转换的通道,ADC_CHANNEL_x,用于模拟看门狗。
+ * @param   values      16倍过采样和。双重模式下为{主ADC, 从ADC}两个值。
+ * @param   n           values的个数。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void sim_adc_sample(ADC_HandleTypeDef *hadc, const uint32_t *channels, const uint16_t *values, uint32_t n)
+{
+    uint32_t index   = (uint32_t)(hadc->Instance - ADC1);
+    sim_adc_dma_t *d = &sim_adc_dma[index];
+
+    sim_adc_watchdog(index, channels, values, n);
+
+    if (d->buffer == NULL || d->length == 0) {
+        return;
+    }
+
+    if (d->word) {
+        ((uint32_t *)d->buffer)[d->pos++] = (uint32_t)values[0] | ((uint32_t)values[1] << 16);
+    } else {
+        for (uint32_t k = 0; k < n; k++) {
+            ((uint16_t *)d->buffer)[d->pos++] = values[k];
+        }
+    }
+
+    uint32_t flag = 0;
+    if (d->pos == d->length / 2) {
+        flag = DMA_ISR_HTIF1;
+    } else if (d->pos >= d->length) {
+        flag = DMA_ISR_TCIF1;
+        d->pos = 0;
+    }
+    if (flag == 0) {
+        return;
+    }
+
+#if (ADC_DMA_FAST_IRQ)
+    DMA_HandleTypeDef *hdma = hadc->DMA_Handle;
+    DMA1->ISR |= flag << hdma->ChannelIndex;
+    if (hadc == &hadc1) {
+        BSP_ADC1_DMA_IRQHandler();
+    } else if (hadc == &hadc2) {
+        BSP_ADC2_DMA_IRQHandler();
+    } else {
+        BSP_ADC3_DMA_IRQHandler();
+    }
+    DMA1->ISR &= ~DMA1->IFCR;
+    DMA1->IFCR = 0;
+#else
+    if (flag == DMA_ISR_HTIF1) {
+        HAL_ADC_ConvHalfCpltCallback(hadc);
+    } else {
+        HAL_ADC_ConvCpltCallback(hadc);
+    }
+#endif
+    sim_hal_sync();
+}
+
+/**************************************************************************************
+ * @brief   比较器同相输入。与阈值DAC的12位数据比较,越限且HRTIM故障输入已使能时
+ *          关闭Timer A/D的全部输出,并进入HRTIM故障中断。比较器迟滞忽略不计。
+ *
+ * @param   comp    COMP1或COMP5。
+ * @param   raw     同相输入电压对应的12位原始值。
+ * @version 1.0
+ * @date    2026 - 10 - 17
+ *************************************************************************************/
+void sim_comp_input(COMP_TypeDef *comp, uint16_t raw)
+{
+    for (uint32_t n = 0; n < sizeof(sim_comp_routes) / sizeof(sim_comp_routes[0]); n++) {
+        const sim_comp_route_t *route = &sim_comp_routes[n];
+        if (route->comp != comp) {
+            continue;
+        }
+        if ((comp->CSR & COMP_CSR_EN) == 0) {
+            sim_fault_input &= ~route->fault_flag;
+            return;
+        }
+
+        uint32_t out = (raw > route->dac->DHR12R1);
+        if (comp->CSR & COMP_CSR_POLARITY) {
+            out = !out;
+        }
+        if (!out) {
+            comp->CSR &= ~COMP_CSR_VALUE;
+            sim_fault_input &= ~route->fault_flag;
+            return;
+        }
+        comp->CSR |= COMP_CSR_VALUE;
+
+        if ((HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_A].FLTxR | HRTIM1->sTimerxRegs[HRTIM_TIMERINDEX_TIMER_D].FLTxR) &
+            route->timer_fault) {
+            sim_fault_input |= route->fault_flag;
+            sim_outputs = 0;
+            HRTIM1->sCommonRegs.ISR |= route->fault_flag;
+            if (HRTIM1->sCommonRegs.IER & route->fault_flag) {
+                BSP_FAULT_IRQHandler();
+                sim_hal_sync();
+            }
+        }
+        return;
+    }
+}
+
+// 上位机(RMCS)发来的一帧控制命令
+void sim_can_receive(uint8_t target_power, uint8_t enabled)
+{
+    memset(sim_can_rx_data, 0, sizeof(sim_can_rx_data));
+    sim_can_rx_data[6] = target_power;
+    sim_can_rx_data[7] = enabled;
+    HAL_FDCAN_RxFifo0Callback(&hfdcan1, FDCAN_IT_RX_FIFO0_NEW_MESSAGE);
+    sim_hal_sync();
+}
+
+// 最近一次发送的状态帧
+const uint8_t *sim_can_last_tx(void)
+{
+    return sim_can_tx_data;
+}
+
+// 板上进入死循环,主机上直接退出,避免仿真结果在出错后继续被使用
+void Error_Handler(void)
+{
+    fprintf(stderr, "Error_Handler called\n");
+    exit(2);
+}
+
+// ------------------------------------------------------------------------------------
+// HAL替身
+// ------------------------------------------------------------------------------------
+
+uint32_t HAL_GetTick(void)
+{
+    return sim_tick;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    (void)Delay;
+}
+
+uint32_t HAL_GetUIDw0(void)
+{
+    return 0;
+}
+
+uint32_t HAL_GetUIDw1(void)
+{
+    return 0;
+}
+
+uint32_t HAL_GetUIDw2(void)
+{
+    return 0;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+    (void)IRQn;
+    (void)PreemptPriority;
+    (void)SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    (void)IRQn;
+}
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+    (void)GPIOx;
+    (void)GPIO_Init;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (PinState == GPIO_PIN_SET) {
+        GPIOx->ODR |= GPIO_Pin;
+    } else {
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    }
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    GPIOx->ODR ^= GPIO_Pin;
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    (void)hdma;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc)
+{
+    (void)hadc;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, const ADC_ChannelConfTypeDef *pConfig)
+{
+    (void)hadc;
+    (void)pConfig;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc, uint32_t SingleDiff)
+{
+    (void)hadc;
+    (void)SingleDiff;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_MultiModeConfigChannel(ADC_HandleTypeDef *hadc, const ADC_MultiModeTypeDef *pMultimode)
+{
+    (void)hadc;
+    (void)pMultimode;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length)
+{
+    sim_adc_dma_t *d = &sim_adc_dma[hadc->Instance - ADC1];
+    d->buffer        = pData;
+    d->length        = Length;
+    d->pos           = 0;
+    d->word          = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_MultiModeStart_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length)
+{
+    HAL_ADC_Start_DMA(hadc, pData, Length);
+    sim_adc_dma[hadc->Instance - ADC1].word = 1;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_AnalogWDGConfig(ADC_HandleTypeDef *hadc, const ADC_AnalogWDGConfTypeDef *pAnalogWDGConfig)
+{
+    uint32_t index = hadc->Instance - ADC1;
+    uint32_t w     = (pAnalogWDGConfig->WatchdogNumber == ADC_ANALOGWATCHDOG_1)   ? 0
+                     : (pAnalogWDGConfig->WatchdogNumber == ADC_ANALOGWATCHDOG_2) ? 1
+                                                                                  : 2;
+
+    sim_adc_awd[index][w].used    = 1;
+    sim_adc_awd[index][w].channel = pAnalogWDGConfig->Channel;
+    sim_adc_awd[index][w].high    = pAnalogWDGConfig->HighThreshold;
+    sim_adc_awd[index][w].low     = pAnalogWDGConfig->LowThreshold;
+    if (pAnalogWDGConfig->ITMode == ENABLE) {
+        hadc->Instance->IER |= sim_awd_flags[w];
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_HRTIM_EventConfig(HRTIM_HandleTypeDef *hhrtim, uint32_t Event, const HRTIM_EventCfgTypeDef *pEventCfg)
+{
+    (void)hhrtim;
+    (void)Event;
+    (void)pEventCfg;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_HRTIM_FaultConfig(HRTIM_HandleTypeDef *hhrtim, uint32_t Fault, const HRTIM_FaultCfgTypeDef *pFaultCfg)
+{
+    (void)hhrtim;
+    (void)Fault;
+    (void)pFaultCfg;
+    return HAL_OK;
+}
+
+void HAL_HRTIM_FaultModeCtl(HRTIM_HandleTypeDef *hhrtim, uint32_t Faults, uint32_t Enable)
+{
+    (void)hhrtim;
+    (void)Faults;
+    (void)Enable;
+}
+
+HAL_StatusTypeDef HAL_HRTIM_WaveformCountStart(HRTIM_HandleTypeDef *hhrtim, uint32_t Timers)
+{
+    (void)hhrtim;
+    (void)Timers;
+    return HAL_OK;
+}
+
+// 故障输入有效期间输出保持在故障状态,开启无效
+HAL_StatusTypeDef HAL_HRTIM_WaveformOutputStart(HRTIM_HandleTypeDef *hhrtim, uint32_t OutputsToStart)
+{
+    (void)hhrtim;
+    if (sim_fault_input == 0) {
+        sim_outputs |= OutputsToStart;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_HRTIM_WaveformOutputStop(HRTIM_HandleTypeDef *hhrtim, uint32_t OutputsToStop)
+{
+    (void)hhrtim;
+    sim_outputs &= ~OutputsToStop;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigFilter(FDCAN_HandleTypeDef *hfdcan, const FDCAN_FilterTypeDef *sFilterConfig)
+{
+    (void)hfdcan;
+    (void)sFilterConfig;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ConfigGlobalFilter(FDCAN_HandleTypeDef *hfdcan, uint32_t NonMatchingStd,
+                                               uint32_t NonMatchingExt, uint32_t RejectRemoteStd,
+                                               uint32_t RejectRemoteExt)
+{
+    (void)hfdcan;
+    (void)NonMatchingStd;
+    (void)NonMatchingExt;
+    (void)RejectRemoteStd;
+    (void)RejectRemoteExt;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_ActivateNotification(FDCAN_HandleTypeDef *hfdcan, uint32_t ActiveITs, uint32_t BufferIndexes)
+{
+    (void)hfdcan;
+    (void)ActiveITs;
+    (void)BufferIndexes;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_Start(FDCAN_HandleTypeDef *hfdcan)
+{
+    (void)hfdcan;
+    return HAL_OK;
+}
+
+uint32_t HAL_FDCAN_GetTxFifoFreeLevel(const FDCAN_HandleTypeDef *hfdcan)
+{
+    (void)hfdcan;
+    return 1;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_AddMessageToTxFifoQ(FDCAN_HandleTypeDef *hfdcan, const FDCAN_TxHeaderTypeDef *pTxHeader,
+                                                const uint8_t *pTxData)
+{
+    (void)hfdcan;
+    // 只保存状态帧,周期统计和CPU占用率帧不影响仿真
+    if (pTxHeader->Identifier == SUPERCAP_ID) {
+        memcpy(sim_can_tx_data, pTxData, sizeof(sim_can_tx_data));
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FDCAN_GetRxMessage(FDCAN_HandleTypeDef *hfdcan, uint32_t RxLocation,
+                                         FDCAN_RxHeaderTypeDef *pRxHeader, uint8_t *pRxData)
+{
+    (void)hfdcan;
+    (void)RxLocation;
+    memset(pRxHeader, 0, sizeof(*pRxHeader));
+    pRxHeader->Identifier = RMCS_ID;
+    pRxHeader->IdType     = FDCAN_STANDARD_ID;
+    pRxHeader->DataLength = FDCAN_DLC_BYTES_8;
+    memcpy(pRxData, sim_can_rx_data, sizeof(sim_can_rx_data));
+    return HAL_OK;
+}
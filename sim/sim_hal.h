@@ -0,0 +1,120 @@
+#pragma once
+#ifndef __SIM_HAL_H__
+#define __SIM_HAL_H__
+
+// 主机仿真用的外设替身。
+// 由Makefile以-include方式在每个源文件最前面包含:先包含真实的HAL头文件取得类型和位定义,
+// 再把固件用到的外设实例宏从固定地址改为指向主机内存中的寄存器结构体,
+// User/Src下的代码不做修改即可在主机上编译运行。HAL函数本身不参与编译,由sim_hal.c给出替身。
+
+#include "stm32g4xx_hal.h"
+
+// 仿真中存在的外设寄存器
+typedef struct
+{
+    RCC_TypeDef rcc;
+    GPIO_TypeDef gpio[6]; // GPIOA ~ GPIOF
+    ADC_TypeDef adc[5];   // ADC1 ~ ADC5
+    DMA_TypeDef dma1;
+    HRTIM_TypeDef hrtim1;
+    COMP_TypeDef comp[7]; // COMP1 ~ COMP7
+    DAC_TypeDef dac[4];   // DAC1 ~ DAC4
+    TIM_TypeDef tim6;
+    TIM_TypeDef tim16;
+    FDCAN_GlobalTypeDef fdcan1;
+    DWT_Type dwt;
+    CoreDebug_Type core_debug;
+} sim_periph_t;
+
+extern sim_periph_t sim_periph;
+
+#undef RCC
+#undef GPIOA
+#undef GPIOB
+#undef GPIOC
+#undef GPIOD
+#undef GPIOE
+#undef GPIOF
+#undef ADC1
+#undef ADC2
+#undef ADC3
+#undef ADC4
+#undef ADC5
+#undef DMA1
+#undef HRTIM1
+#undef COMP1
+#undef COMP2
+#undef COMP3
+#undef COMP4
+#undef COMP5
+#undef COMP6
+#undef COMP7
+#undef DAC1
+#undef DAC2
+#undef DAC3
+#undef DAC4
+#undef TIM6
+#undef TIM16
+#undef FDCAN1
+#undef DWT
+#undef CoreDebug
+
+#define RCC    (&sim_periph.rcc)
+#define GPIOA  (&sim_periph.gpio[0])
+#define GPIOB  (&sim_periph.gpio[1])
+#define GPIOC  (&sim_periph.gpio[2])
+#define GPIOD  (&sim_periph.gpio[3])
+#define GPIOE  (&sim_periph.gpio[4])
+#define GPIOF  (&sim_periph.gpio[5])
+#define ADC1   (&sim_periph.adc[0])
+#define ADC2   (&sim_periph.adc[1])
+#define ADC3   (&sim_periph.adc[2])
+#define ADC4   (&sim_periph.adc[3])
+#define ADC5   (&sim_periph.adc[4])
+#define DMA1   (&sim_periph.dma1)
+#define HRTIM1 (&sim_periph.hrtim1)
+#define COMP1  (&sim_periph.comp[0])
+#define COMP2  (&sim_periph.comp[1])
+#define COMP3  (&sim_periph.comp[2])
+#define COMP4  (&sim_periph.comp[3])
+#define COMP5  (&sim_periph.comp[4])
+#define COMP6  (&sim_periph.comp[5])
+#define COMP7  (&sim_periph.comp[6])
+#define DAC1   (&sim_periph.dac[0])
+#define DAC2   (&sim_periph.dac[1])
+#define DAC3   (&sim_periph.dac[2])
+#define DAC4   (&sim_periph.dac[3])
+#define TIM6   (&sim_periph.tim6)
+#define TIM16  (&sim_periph.tim16)
+#define FDCAN1 (&sim_periph.fdcan1)
+#define DWT    (&sim_periph.dwt)
+#define CoreDebug (&sim_periph.core_debug)
+
+// 仿真是单线程的,中断由事件循环依次调用,不会互相抢占,开关中断的内核指令替换为空操作
+#define __get_PRIMASK()           (0U)
+#define __set_PRIMASK(priMask)    ((void)(priMask))
+#define __disable_irq()           ((void)0)
+#define __enable_irq()            ((void)0)
+
+// 板上的时钟与定时参数,与hrtim.c/tim.c中的配置一致
+#define SIM_SYSCLK_HZ         (170000000.0)
+#define SIM_HRTIM_PERIOD      (27200U)
+#define SIM_HRTIM_CLOCK_HZ    (SIM_SYSCLK_HZ * 32.0)
+#define SIM_ADC_TRIGGER_DIV   (10U) // HRTIM_ADCTRIGGER_1/3后分频的复位值,fsbb_pwm_init按FSBB_ADC_TRIGGER_DIV重新设置
+#define SIM_TIM6_PERIOD_S     (171.0 * 50.0 / SIM_SYSCLK_HZ)
+#define SIM_TIM16_PERIOD_S    (171.0 * 2000.0 / SIM_SYSCLK_HZ)
+#define SIM_ADC_TRIGGER_S     (sim_adc_trigger_period())
+
+extern void sim_hal_init(void);
+extern void sim_hal_set_time(double t);
+extern void sim_hal_sync(void);
+extern double sim_adc_trigger_period(void);
+extern uint32_t sim_hal_outputs(void);
+extern float sim_hrtim_duty(uint32_t timer);
+extern uint8_t sim_hrtim_burst(void);
+extern void sim_adc_sample(ADC_HandleTypeDef *hadc, const uint32_t *channels, const uint16_t *values, uint32_t n);
+extern void sim_comp_input(COMP_TypeDef *comp, uint16_t raw);
+extern void sim_can_receive(uint8_t target_power, uint8_t enabled);
+extern const uint8_t *sim_can_last_tx(void);
+
+#endif // !__SIM_HAL_H__